@@ -199,7 +199,7 @@ namespace Petri.Editor.Code
                 return "(*PetriNet_getVariable(petriNet, (uint_fast32_t)(" + Prefix + Expression + ")))";
             }
             else if(Language == Language.Cpp) {
-                return "petriNet.getVariable(static_cast<std::uint_fast32_t>(" + Prefix + Expression + ")).value()";
+                return MakeAtomicCode(AtomicLoad ? "load()" : "value()");
             }
             else if(Language == Language.CSharp) {
                 return "petriNet.GetVariable((UInt32)(" + Prefix + Expression + ")).Value";
@@ -207,6 +207,26 @@ namespace Petri.Editor.Code
             throw new Exception("VariableExpression.MakeCode: Should not get there!");
         }
 
+        /// <summary>
+        /// Makes the code invoking a method of the Atomic variable of the runtime.
+        /// </summary>
+        /// <returns>The code.</returns>
+        /// <param name="method">The method invocation, such as "load()".</param>
+        public string MakeAtomicCode(string method)
+        {
+            return "petriNet.getVariable(static_cast<std::uint_fast32_t>(" + Prefix + Expression + "))." + method;
+        }
+
+        /// <summary>
+        /// Gets or sets whether the generated code reads the variable with a lock-free load, instead of accessing its value under its lock.
+        /// Only the C++ code generator supports it.
+        /// </summary>
+        /// <value><c>true</c> if the variable is read with a lock-free load.</value>
+        public bool AtomicLoad {
+            get;
+            set;
+        }
+
         public override string MakeUserReadable()
         {
             return "$" + Expression;
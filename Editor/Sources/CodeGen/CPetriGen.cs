@@ -299,8 +299,8 @@ namespace Petri.Editor
                     var newID = lastID.Consume();
                     string tName = name + "_" + newID.ToString();
 
-                    CodeGen += "PetriAction_addTransition(" + name + ", " + newID.ToString()
-                    + ", \"" + tName + "\", " + s.CodeIdentifier + ", &PetriUtility_returnTrue);";
+                    CodeGen += "PetriTransition_setPure(PetriAction_addTransition(" + name + ", " + newID.ToString()
+                    + ", \"" + tName + "\", " + s.CodeIdentifier + ", &PetriUtility_returnTrue), true);";
                 }
             }
         }
@@ -309,6 +309,8 @@ namespace Petri.Editor
         {
             var old = new Dictionary<LiteralExpression, string>();
             string enumName = Document.Settings.Enum.Name;
+            bool pure = IsPure(t.Condition);
+            var expected = GetExpectedResult(t.Condition);
 
             foreach(LiteralExpression le in t.Condition.GetLiterals()) {
                 if(le.Expression == "$Res" || le.Expression == "$Result") {
@@ -375,9 +377,15 @@ namespace Petri.Editor
 
             CodeRanges[t] = range;
 
-            var decl = cppVar.Count > 0 ? "struct PetriTransition *" + t.CodeIdentifier + " = " : "";
+            var decl = (cppVar.Count > 0 || pure || expected != null) ? "struct PetriTransition *" + t.CodeIdentifier + " = " : "";
             CodeGen += decl + "PetriAction_addTransitionWithParam(" + bName + ", " + t.ID.ToString() + ", \"" + t.Name + "\", " + aName + ", "
             + "&" + t.CodeIdentifier + "_invocation" + ");";
+            if(pure) {
+                CodeGen += "PetriTransition_setPure(" + t.CodeIdentifier + ", true);";
+            }
+            if(expected != null) {
+                CodeGen += "PetriTransition_setExpectedResult(" + t.CodeIdentifier + ", " + expected.MakeCode() + ");";
+            }
             foreach(var v in cppVar) {
                 CodeGen += "PetriTransition_addVariable(" + t.CodeIdentifier + ", (uint32_t)(" + v.Prefix + v.Expression + "));";
             }
@@ -98,6 +98,7 @@ namespace Petri.Editor
             CodeGen += "#include \"Runtime/Cpp/PetriUtils.h\"";
             CodeGen += "#include \"Runtime/Cpp/Action.h\"";
             CodeGen += "#include \"Runtime/Cpp/Atomic.h\"";
+            CodeGen += "#include \"Runtime/Cpp/StaticPetriNet.h\"";
             foreach(var s in Document.Headers) {
                 var p1 = System.IO.Path.Combine(System.IO.Directory.GetParent(Document.Path).FullName,
                                                 s);
@@ -119,19 +120,12 @@ namespace Petri.Editor
 
             CodeGen += "namespace {";
             _prototypesIndex = CodeGen.Value.Length;
-            CodeGen += "void fill(PetriNet &petriNet) {";
-
-            foreach(var e in Document.PetriNet.Variables) {
-                CodeGen += "petriNet.addVariable(static_cast<std::uint_fast32_t>(" + e.Prefix + e.Expression + "));";
-            }
         }
 
         protected override void End()
         {
             CodeGen.Value = CodeGen.Value.Substring(0, _prototypesIndex) + _functionPrototypes.Value + "\n" + CodeGen.Value.Substring(_prototypesIndex);
 
-            CodeGen += "}"; // fill()
-
             int linesSoFar = CodeGen.LineCount;
             var keys = new List<Entity>(CodeRanges.Keys);
             foreach(var key in keys) {
@@ -144,6 +138,13 @@ namespace Petri.Editor
 
             CodeGen += _functionBodies.Value;
 
+            GenerateNetTables();
+
+            // The tables are added in a single pass, instead of a long function adding the entities one by one
+            CodeGen += "void fill(PetriNet &petriNet) {";
+            CodeGen += "petriNet.build(staticNet);";
+            CodeGen += "}";
+
             CodeGen += "}"; // namespace
 
             string toHash = CodeGen.Value;
@@ -255,7 +256,9 @@ namespace Petri.Editor
                 }
             }
 
-            var cpp = "static_cast<actionResult_t>(" + a.Function.MakeCode() + ")";
+            var atomic = GetAtomicAccess(a.Function);
+            var modified = GetModifiedVariables(a.Function);
+            var cpp = "static_cast<actionResult_t>(" + MakeCode(a.Function, atomic) + ")";
 
             var cppVar = new HashSet<VariableExpression>();
             a.GetVariables(cppVar);
@@ -271,11 +274,15 @@ namespace Petri.Editor
 
             string action = "&" + a.CodeIdentifier + "_invocation";
 
-            CodeGen += "auto &" + a.CodeIdentifier + " = " + "petriNet.addAction("
-            + "Action(" + a.ID.ToString() + ", \"" + a.Parent.Name + "_" + a.Name + "\", " + action + ", " + a.RequiredTokens.ToString() + "), " + ((a.Active && (a.Parent is RootPetriNet)) ? "true" : "false") + ");";
+            var staticAction = AddStaticAction(a.CodeIdentifier,
+                                               a.ID.ToString(),
+                                               a.Parent.Name + "_" + a.Name,
+                                               action,
+                                               a.RequiredTokens.ToString(),
+                                               a.Active && (a.Parent is RootPetriNet));
 
             foreach(var v in cppVar) {
-                CodeGen += a.CodeIdentifier + ".addVariable(" + "static_cast<std::uint_fast32_t>(" + v.Prefix + v.Expression + "));";
+                staticAction.Variables.Add(MakeStaticVariable(v, atomic, modified));
             }
 
             foreach(var tup in old) {
@@ -285,9 +292,12 @@ namespace Petri.Editor
 
         protected override void GenerateExitPoint(ExitPoint e, IDManager lastID)
         {
-            CodeGen += "auto &" + e.CodeIdentifier + " = petriNet.addAction(" +
-            "Action(" + e.ID.ToString() + ", \"" + e.Parent.Name + "_" + e.Name + "\", make_action_callable([](){ return actionResult_t(); }), " + e.RequiredTokens.ToString()
-            + "), false);";
+            AddStaticAction(e.CodeIdentifier,
+                            e.ID.ToString(),
+                            e.Parent.Name + "_" + e.Name,
+                            "&StaticNet::emptyAction",
+                            e.RequiredTokens.ToString(),
+                            false);
         }
 
         protected override void GenerateInnerPetriNet(InnerPetriNet i, IDManager lastID)
@@ -295,8 +305,12 @@ namespace Petri.Editor
             string name = i.EntryPointName;
 
             // Adding an entry point
-            CodeGen += "auto &" + name + " = petriNet.addAction("
-            + "Action(" + i.EntryPointID + ", \"" + i.Name + "_Entry\", make_action_callable([](){ return actionResult_t(); }), " + i.RequiredTokens.ToString() + "), " + (i.Active ? "true" : "false") + ");";
+            var entryPoint = AddStaticAction(name,
+                                             i.EntryPointID.ToString(),
+                                             i.Name + "_Entry",
+                                             "&StaticNet::emptyAction",
+                                             i.RequiredTokens.ToString(),
+                                             i.Active);
 
             // Adding a transition from the entry point to all of the initially active states
             foreach(State s in i.States) {
@@ -304,7 +318,12 @@ namespace Petri.Editor
                     var newID = lastID.Consume();
                     string tName = name + "_" + newID.ToString();
 
-                    CodeGen += name + ".addTransition(" + newID.ToString() + ", \"" + tName + "\", " + s.CodeIdentifier + ", make_transition_callable([](actionResult_t){ return true; }));";
+                    entryPoint.Transitions.Add(new StaticTransition(newID.ToString(),
+                                                                    tName,
+                                                                    s.CodeIdentifier,
+                                                                    "&StaticNet::alwaysFulfilled",
+                                                                    true,
+                                                                    null));
                 }
             }
         }
@@ -313,6 +332,8 @@ namespace Petri.Editor
         {
             var old = new Dictionary<LiteralExpression, string>();
             string enumName = Document.Settings.Enum.Name;
+            bool pure = IsPure(t.Condition);
+            var expected = GetExpectedResult(t.Condition);
 
             foreach(LiteralExpression le in t.Condition.GetLiterals()) {
                 if(le.Expression == "$Res" || le.Expression == "$Result") {
@@ -350,7 +371,9 @@ namespace Petri.Editor
                 aName = a.EntryPointName;
             }
 
-            string cpp = "return " + t.Condition.MakeCode() + ";";
+            var atomic = GetAtomicAccess(t.Condition);
+            var modified = GetModifiedVariables(t.Condition);
+            string cpp = "return " + MakeCode(t.Condition, atomic) + ";";
 
             var cppVar = new HashSet<VariableExpression>();
             t.GetVariables(cppVar);
@@ -366,9 +389,16 @@ namespace Petri.Editor
 
             cpp = "&" + t.CodeIdentifier + "_invocation";
 
-            CodeGen += "auto &" + t.CodeIdentifier + " = " + bName + ".addTransition(" + t.ID.ToString() + ", \"" + t.Name + "\", " + aName + ", " + cpp + ");";
+            var staticTransition = new StaticTransition(t.ID.ToString(),
+                                                        t.Name,
+                                                        aName,
+                                                        cpp,
+                                                        pure,
+                                                        expected != null ? expected.MakeCode() : null);
+            _staticActions[bName].Transitions.Add(staticTransition);
+
             foreach(var v in cppVar) {
-                CodeGen += t.CodeIdentifier + ".addVariable(" + "static_cast<std::uint_fast32_t>(" + v.Prefix + v.Expression + "));";
+                staticTransition.Variables.Add(MakeStaticVariable(v, atomic, modified));
             }
 
             foreach(var tup in old) {
@@ -376,6 +406,189 @@ namespace Petri.Editor
             }
         }
 
+        /// <summary>
+        /// Makes the code of an action's function or a transition's condition, accessing its variable through the given lock-free operation if any.
+        /// </summary>
+        /// <returns>The code.</returns>
+        /// <param name="expression">The expression.</param>
+        /// <param name="atomic">The lock-free operation, or <c>null</c> if the variables are locked.</param>
+        string MakeCode(Expression expression, AtomicAccess atomic)
+        {
+            if(atomic == null) {
+                return expression.MakeCode();
+            }
+            else if(atomic.Operation == AtomicAccess.Kind.Load) {
+                atomic.Variable.AtomicLoad = true;
+                var code = expression.MakeCode();
+                atomic.Variable.AtomicLoad = false;
+                return code;
+            }
+
+            string update;
+            switch(atomic.Operation) {
+            case AtomicAccess.Kind.Store:
+                update = atomic.Variable.MakeAtomicCode("store(" + atomic.Operand.MakeCode() + ")");
+                break;
+            case AtomicAccess.Kind.Add:
+                update = atomic.Variable.MakeAtomicCode("fetchAdd(" + atomic.Operand.MakeCode() + ")");
+                break;
+            default:
+                update = atomic.Variable.MakeAtomicCode("fetchAdd(-(" + atomic.Operand.MakeCode() + "))");
+                break;
+            }
+
+            // The update replaces the whole expression of the action, which is wrapped into a function.
+            var returnType = ((WrapperFunctionInvocation)expression).Function.ReturnType.Name;
+            return "([&petriNet]() -> " + returnType + " { " + update + "; return {}; })()";
+        }
+
+        /// <summary>
+        /// Makes the entry of a variable of an entity in the variables table of the petri net.
+        /// </summary>
+        /// <returns>The StaticVariable initializer.</returns>
+        /// <param name="variable">The variable.</param>
+        /// <param name="atomic">The lock-free operation of the entity, or <c>null</c> if its variables are locked.</param>
+        /// <param name="modified">The variables the entity may modify.</param>
+        static string MakeStaticVariable(VariableExpression variable, AtomicAccess atomic, HashSet<VariableExpression> modified)
+        {
+            return "{static_cast<std::uint_fast32_t>(" + variable.Prefix + variable.Expression + "), VariableAccess::" + GetAccess(variable,
+                                                                                                                                     atomic,
+                                                                                                                                     modified) + "}";
+        }
+
+        /// <summary>
+        /// Gets the name of the VariableAccess value with which an entity accesses one of its variables.
+        /// </summary>
+        /// <returns>The name of the access.</returns>
+        /// <param name="variable">The variable.</param>
+        /// <param name="atomic">The lock-free operation of the entity, or <c>null</c> if its variables are locked.</param>
+        /// <param name="modified">The variables the entity may modify.</param>
+        static string GetAccess(VariableExpression variable, AtomicAccess atomic, HashSet<VariableExpression> modified)
+        {
+            if(atomic != null) {
+                return "LockFree";
+            }
+            else if(!modified.Contains(variable)) {
+                return "Shared";
+            }
+
+            return "Exclusive";
+        }
+
+        /// <summary>
+        /// An action of the petri net tables, with its outgoing transitions in the order they were added.
+        /// </summary>
+        class StaticAction
+        {
+            public StaticAction(string id, string name, string function, string requiredTokens, bool active)
+            {
+                ID = id;
+                Name = name;
+                Function = function;
+                RequiredTokens = requiredTokens;
+                Active = active;
+                Variables = new List<string>();
+                Transitions = new List<StaticTransition>();
+            }
+
+            public string ID { get; private set; }
+            public string Name { get; private set; }
+            public string Function { get; private set; }
+            public string RequiredTokens { get; private set; }
+            public bool Active { get; private set; }
+            public List<string> Variables { get; private set; }
+            public List<StaticTransition> Transitions { get; private set; }
+        }
+
+        /// <summary>
+        /// A transition of the petri net tables, leading to the action designated by its code identifier.
+        /// </summary>
+        class StaticTransition
+        {
+            public StaticTransition(string id, string name, string target, string condition, bool pure, string expectedResult)
+            {
+                ID = id;
+                Name = name;
+                Target = target;
+                Condition = condition;
+                Pure = pure;
+                ExpectedResult = expectedResult;
+                Variables = new List<string>();
+            }
+
+            public string ID { get; private set; }
+            public string Name { get; private set; }
+            public string Target { get; private set; }
+            public string Condition { get; private set; }
+            public bool Pure { get; private set; }
+            public string ExpectedResult { get; private set; }
+            public List<string> Variables { get; private set; }
+        }
+
+        /// <summary>
+        /// Records an action of the petri net, in the order of the actions table.
+        /// </summary>
+        /// <returns>The action, to which its variables and transitions are then added.</returns>
+        StaticAction AddStaticAction(string identifier, string id, string name, string function, string requiredTokens, bool active)
+        {
+            var action = new StaticAction(id, name, function, requiredTokens, active);
+            _staticActionsOrder.Add(identifier);
+            _staticActions.Add(identifier, action);
+
+            return action;
+        }
+
+        /// <summary>
+        /// Generates the constant tables describing the petri net. <c>fill()</c> adds its actions and transitions from them in a single pass.
+        /// The transitions are grouped by action, and designate their target by its index in the actions table.
+        /// </summary>
+        void GenerateNetTables()
+        {
+            var indices = new Dictionary<string, int>();
+            foreach(var identifier in _staticActionsOrder) {
+                indices.Add(identifier, indices.Count);
+            }
+
+            var variables = new List<string>();
+            var transitions = new List<string>();
+            var actions = new List<string>();
+            foreach(var identifier in _staticActionsOrder) {
+                var a = _staticActions[identifier];
+                int transitionsBegin = transitions.Count;
+                foreach(var t in a.Transitions) {
+                    int variablesBegin = variables.Count;
+                    variables.AddRange(t.Variables);
+                    transitions.Add("{" + t.ID + ", \"" + t.Name + "\", " + indices[t.Target] + ", " + t.Condition + ", "
+                    + (t.Pure ? "true" : "false") + ", " + (t.ExpectedResult != null ? "true, " + t.ExpectedResult : "false, 0") + ", "
+                    + variablesBegin + ", " + variables.Count + "}");
+                }
+
+                int actionVariablesBegin = variables.Count;
+                variables.AddRange(a.Variables);
+                actions.Add("{" + a.ID + ", \"" + a.Name + "\", " + a.Function + ", " + a.RequiredTokens + ", " + (a.Active ? "true" : "false") + ", "
+                + transitionsBegin + ", " + transitions.Count + ", " + actionVariablesBegin + ", " + variables.Count + "}");
+            }
+
+            var netVariables = from v in Document.PetriNet.Variables
+                                        select "static_cast<std::uint_fast32_t>(" + v.Prefix + v.Expression + ")";
+
+            Func<string, string, List<string>, string> table = (string type, string name, List<string> entries) => {
+                if(entries.Count == 0) {
+                    return "nullptr, 0";
+                }
+                CodeGen += "constexpr " + type + " " + name + "[] = {" + String.Join(",\n", entries) + "};";
+                return name + ", " + entries.Count;
+            };
+
+            string netVariablesTable = table("std::uint_fast32_t", "staticNetVariables", netVariables.ToList());
+            string variablesTable = table("StaticVariable", "staticVariables", variables);
+            string transitionsTable = table("StaticTransition", "staticTransitions", transitions);
+            string actionsTable = table("StaticAction", "staticActions", actions);
+
+            CodeGen += "constexpr StaticNet staticNet = {" + actionsTable + ", " + transitionsTable + ", " + variablesTable + ", "
+            + netVariablesTable + "};";
+        }
+
         protected string GenerateVarEnum()
         {
             var variables = Document.PetriNet.Variables;
@@ -389,6 +602,8 @@ namespace Petri.Editor
             return "";
         }
 
+        private Dictionary<string, StaticAction> _staticActions = new Dictionary<string, StaticAction>();
+        private List<string> _staticActionsOrder = new List<string>();
         private CodeGen _functionBodies;
         private CodeGen _functionPrototypes;
         private CodeGen _headerGen;
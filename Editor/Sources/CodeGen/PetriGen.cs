@@ -23,6 +23,7 @@
 using System;
 using Petri.Editor.Code;
 using System.Collections.Generic;
+using System.Linq;
 
 namespace Petri.Editor
 {
@@ -228,6 +229,334 @@ namespace Petri.Editor
         /// <param name="lastID">Last ID.</param>
         protected abstract void GenerateTransition(Transition t);
 
+        /// <summary>
+        /// Checks whether a transition's condition only depends on the result of the preceding action and on the petri net variables.
+        /// Such a condition can not change until one of its variables is modified, so the runtime does not need to poll it.
+        /// </summary>
+        /// <returns><c>true</c> if the condition is pure, <c>false</c> otherwise.</returns>
+        /// <param name="condition">The condition to inspect.</param>
+        protected bool IsPure(Expression condition)
+        {
+            if(condition is EmptyExpression || condition is VariableExpression) {
+                return true;
+            }
+            else if(condition is LiteralExpression) {
+                string literal = ((LiteralExpression)condition).Expression;
+                return literal == "$Res" || literal == "$Result" || literal == "$Name" || literal == "$ID"
+                || literal == "true" || literal == "false"
+                || Document.Settings.Enum.Members.Contains(literal)
+                || System.Text.RegularExpressions.Regex.IsMatch(literal, "^" + Parser.NumberPattern + "$");
+            }
+            else if(condition is UnaryExpression) {
+                switch(condition.Operator) {
+                case Operator.Name.UnaryPlus:
+                case Operator.Name.UnaryMinus:
+                case Operator.Name.LogicalNot:
+                case Operator.Name.BitwiseNot:
+                    return IsPure(((UnaryExpression)condition).Expression);
+                default:
+                    return false;
+                }
+            }
+            else if(condition is BinaryExpression) {
+                switch(condition.Operator) {
+                case Operator.Name.Mult:
+                case Operator.Name.Div:
+                case Operator.Name.Mod:
+                case Operator.Name.Plus:
+                case Operator.Name.Minus:
+                case Operator.Name.ShiftLeft:
+                case Operator.Name.ShiftRight:
+                case Operator.Name.Less:
+                case Operator.Name.LessEqual:
+                case Operator.Name.Greater:
+                case Operator.Name.GreaterEqual:
+                case Operator.Name.Equal:
+                case Operator.Name.NotEqual:
+                case Operator.Name.BitwiseAnd:
+                case Operator.Name.BitwiseXor:
+                case Operator.Name.BitwiseOr:
+                case Operator.Name.LogicalAnd:
+                case Operator.Name.LogicalOr:
+                    var binary = (BinaryExpression)condition;
+                    return IsPure(binary.Expression1) && IsPure(binary.Expression2);
+                default:
+                    return false;
+                }
+            }
+            else if(condition is TernaryConditionExpression) {
+                var ternary = (TernaryConditionExpression)condition;
+                return IsPure(ternary.Expression1) && IsPure(ternary.Expression2) && IsPure(ternary.Expression3);
+            }
+
+            // Function invocations and everything else may read some state the runtime does not know of.
+            return false;
+        }
+
+        /// <summary>
+        /// Finds the constant a transition's condition compares the result of the preceding action with, when the condition is only such an equality, e.g. <c>$Res == OK</c>.
+        /// The runtime then picks the transition by looking the result up in a table, without evaluating its condition.
+        /// </summary>
+        /// <returns>The enum member or integer literal the result is compared with, or <c>null</c> if the condition is anything else.</returns>
+        /// <param name="condition">The condition to inspect.</param>
+        protected LiteralExpression GetExpectedResult(Expression condition)
+        {
+            var binary = condition as BinaryExpression;
+            if(binary == null || binary.Operator != Operator.Name.Equal) {
+                return null;
+            }
+
+            Func<Expression, bool> isResult = (Expression e) => {
+                var literal = e as LiteralExpression;
+                return literal != null && !(literal is VariableExpression)
+                    && (literal.Expression == "$Res" || literal.Expression == "$Result");
+            };
+            Func<Expression, bool> isConstant = (Expression e) => {
+                var literal = e as LiteralExpression;
+                return literal != null && !(literal is VariableExpression)
+                    && (Document.Settings.Enum.Members.Contains(literal.Expression)
+                        || System.Text.RegularExpressions.Regex.IsMatch(literal.Expression, "^[0-9]+$"));
+            };
+
+            if(isResult(binary.Expression1) && isConstant(binary.Expression2)) {
+                return (LiteralExpression)binary.Expression2;
+            }
+            else if(isConstant(binary.Expression1) && isResult(binary.Expression2)) {
+                return (LiteralExpression)binary.Expression1;
+            }
+
+            return null;
+        }
+
+        /// <summary>
+        /// A single lock-free operation on a petri net variable, which is the only access of an entity to its variables.
+        /// </summary>
+        protected class AtomicAccess
+        {
+            public enum Kind
+            {
+                Load,
+                Store,
+                Add,
+                Subtract,
+            }
+
+            public AtomicAccess(Kind operation, VariableExpression variable, Expression operand)
+            {
+                Operation = operation;
+                Variable = variable;
+                Operand = operand;
+            }
+
+            /// <summary>
+            /// Gets the operation performed on the variable.
+            /// </summary>
+            /// <value>The operation.</value>
+            public Kind Operation { get; private set; }
+
+            /// <summary>
+            /// Gets the variable accessed by the operation.
+            /// </summary>
+            /// <value>The variable.</value>
+            public VariableExpression Variable { get; private set; }
+
+            /// <summary>
+            /// Gets the value stored, added or subtracted, which does not depend on any variable. It is <c>null</c> for a load.
+            /// </summary>
+            /// <value>The operand.</value>
+            public Expression Operand { get; private set; }
+        }
+
+        /// <summary>
+        /// Checks whether the expression of an action or the condition of a transition only accesses its variables through a single lock-free operation.
+        /// The variable then does not need to be locked while the entity is executed or evaluated.
+        /// This is the case of an expression reading its only variable once, and of an action incrementing, decrementing, adding a value to or assigning a value to its only variable.
+        /// A variable is only updated this way when no other entity locks it, as the update could otherwise be overwritten by that entity.
+        /// </summary>
+        /// <returns>The lock-free operation, or <c>null</c> if the variables of the expression have to be locked.</returns>
+        /// <param name="expression">The function of an action or the condition of a transition.</param>
+        protected AtomicAccess GetAtomicAccess(Expression expression)
+        {
+            var access = FindAtomicAccess(expression);
+            if(access != null && access.Operation != AtomicAccess.Kind.Load && LockedVariables.Contains(access.Variable)) {
+                return null;
+            }
+
+            return access;
+        }
+
+        AtomicAccess FindAtomicAccess(Expression expression)
+        {
+            var variables = expression.GetVariables();
+            if(variables.Count == 1 && GetModifiedVariables(expression).Count == 0) {
+                return new AtomicAccess(AtomicAccess.Kind.Load, variables[0], null);
+            }
+
+            // Only an action's expression, which is wrapped into a function for the runtime, may update a variable.
+            var wrapper = expression as WrapperFunctionInvocation;
+            if(wrapper == null) {
+                return null;
+            }
+            expression = wrapper.Arguments[0];
+
+            var unary = expression as UnaryExpression;
+            if(unary != null && unary.Expression is VariableExpression) {
+                var variable = (VariableExpression)unary.Expression;
+                var one = LiteralExpression.CreateFromString("1", Language);
+                switch(unary.Operator) {
+                case Operator.Name.PreIncr:
+                case Operator.Name.PostIncr:
+                    return new AtomicAccess(AtomicAccess.Kind.Add, variable, one);
+                case Operator.Name.PreDecr:
+                case Operator.Name.PostDecr:
+                    return new AtomicAccess(AtomicAccess.Kind.Subtract, variable, one);
+                }
+            }
+
+            var assignment = expression as BinaryExpression;
+            if(assignment != null && assignment.Operator == Operator.Name.Assignment && assignment.Expression1 is VariableExpression) {
+                var variable = (VariableExpression)assignment.Expression1;
+                var value = assignment.Expression2;
+                var valueVariables = value.GetVariables();
+                if(valueVariables.Count == 0) {
+                    return new AtomicAccess(AtomicAccess.Kind.Store, variable, value);
+                }
+
+                var sum = value as BinaryExpression;
+                if(sum != null && valueVariables.Count == 1) {
+                    if(sum.Operator == Operator.Name.Plus && variable.Equals(sum.Expression1)) {
+                        return new AtomicAccess(AtomicAccess.Kind.Add, variable, sum.Expression2);
+                    }
+                    else if(sum.Operator == Operator.Name.Plus && variable.Equals(sum.Expression2)) {
+                        return new AtomicAccess(AtomicAccess.Kind.Add, variable, sum.Expression1);
+                    }
+                    else if(sum.Operator == Operator.Name.Minus && variable.Equals(sum.Expression1)) {
+                        return new AtomicAccess(AtomicAccess.Kind.Subtract, variable, sum.Expression2);
+                    }
+                }
+            }
+
+            return null;
+        }
+
+        /// <summary>
+        /// Gets the variables an expression may modify, as opposed to the ones it only reads.
+        /// A variable is considered modified when it is assigned, incremented or decremented, when its address is taken, or when it is passed to a function which may take it by reference.
+        /// </summary>
+        /// <returns>The variables that may be modified.</returns>
+        /// <param name="expression">The expression to inspect.</param>
+        protected HashSet<VariableExpression> GetModifiedVariables(Expression expression)
+        {
+            var result = new HashSet<VariableExpression>();
+            AddModifiedVariables(expression, result);
+            return result;
+        }
+
+        void AddModifiedVariables(Expression expression, HashSet<VariableExpression> result)
+        {
+            if(expression is VariableExpression || expression.GetVariables().Count == 0) {
+                return;
+            }
+            else if(expression is UnaryExpression) {
+                switch(expression.Operator) {
+                case Operator.Name.UnaryPlus:
+                case Operator.Name.UnaryMinus:
+                case Operator.Name.LogicalNot:
+                case Operator.Name.BitwiseNot:
+                    AddModifiedVariables(((UnaryExpression)expression).Expression, result);
+                    return;
+                }
+            }
+            else if(expression is BinaryExpression) {
+                var binary = (BinaryExpression)expression;
+                switch(expression.Operator) {
+                case Operator.Name.Mult:
+                case Operator.Name.Div:
+                case Operator.Name.Mod:
+                case Operator.Name.Plus:
+                case Operator.Name.Minus:
+                case Operator.Name.ShiftLeft:
+                case Operator.Name.ShiftRight:
+                case Operator.Name.Less:
+                case Operator.Name.LessEqual:
+                case Operator.Name.Greater:
+                case Operator.Name.GreaterEqual:
+                case Operator.Name.Equal:
+                case Operator.Name.NotEqual:
+                case Operator.Name.BitwiseAnd:
+                case Operator.Name.BitwiseXor:
+                case Operator.Name.BitwiseOr:
+                case Operator.Name.LogicalAnd:
+                case Operator.Name.LogicalOr:
+                case Operator.Name.Comma:
+                    AddModifiedVariables(binary.Expression1, result);
+                    AddModifiedVariables(binary.Expression2, result);
+                    return;
+                case Operator.Name.Assignment:
+                    result.UnionWith(binary.Expression1.GetVariables());
+                    AddModifiedVariables(binary.Expression2, result);
+                    return;
+                }
+            }
+            else if(expression is TernaryConditionExpression) {
+                var ternary = (TernaryConditionExpression)expression;
+                AddModifiedVariables(ternary.Expression1, result);
+                AddModifiedVariables(ternary.Expression2, result);
+                AddModifiedVariables(ternary.Expression3, result);
+                return;
+            }
+            else if(expression is ExpressionList) {
+                foreach(var e in ((ExpressionList)expression).Expressions) {
+                    AddModifiedVariables(e, result);
+                }
+                return;
+            }
+            else if(expression is FunctionInvocation && !(expression is MethodInvocation)) {
+                // This includes the wrapper of an action's expression, whose parameter is not a reference.
+                var invocation = (FunctionInvocation)expression;
+                for(int i = 0; i < invocation.Arguments.Count; ++i) {
+                    var type = invocation.Function.Parameters[i].Type;
+                    if(type.IsReference || type.Equals(Code.Type.UnknownType(Language))) {
+                        result.UnionWith(invocation.Arguments[i].GetVariables());
+                    }
+                    else {
+                        AddModifiedVariables(invocation.Arguments[i], result);
+                    }
+                }
+                return;
+            }
+
+            // Everything else may modify any of its variables.
+            result.UnionWith(expression.GetVariables());
+        }
+
+        /// <summary>
+        /// Gets the variables which are locked by at least one entity of the document.
+        /// </summary>
+        /// <value>The locked variables.</value>
+        HashSet<VariableExpression> LockedVariables {
+            get {
+                if(_lockedVariables == null) {
+                    _lockedVariables = new HashSet<VariableExpression>();
+                    foreach(Entity e in Document.PetriNet.BuildEntitiesList()) {
+                        Expression expression = null;
+                        if(e is Action) {
+                            expression = ((Action)e).Function;
+                        }
+                        else if(e is Transition) {
+                            expression = ((Transition)e).Condition;
+                        }
+
+                        if(expression != null && FindAtomicAccess(expression) == null) {
+                            _lockedVariables.UnionWith(expression.GetVariables());
+                        }
+                    }
+                }
+
+                return _lockedVariables;
+            }
+        }
+
         /// <summary>
         /// Finishes the code generation and compute the Hash value of the petri net.
         /// </summary>
@@ -304,6 +633,8 @@ namespace Petri.Editor
                 return Document.Settings.Name;
             }
         }
+
+        HashSet<VariableExpression> _lockedVariables;
     }
 }
 
@@ -110,6 +110,191 @@ namespace Petri.Test
             Assert.IsEmpty(stderr);
         }
 
+        public static bool VariableIsSet(System.IntPtr petriNet, System.Int32 result)
+        {
+            return Petri.Runtime.Interop.PetriNet.PetriNet_getVariableValue(petriNet, 0) == 1;
+        }
+
+        [Test(), Timeout(10000)]
+        public void TestRuntimePureTransitionWakesOnChange()
+        {
+            // GIVEN a petri net waiting for a pure transition which is never polled
+            PetriNet pn = new PetriNet("Test");
+            pn.AddVariable(0);
+
+            Action a1 = new Action(1, "action1", Action1, 1);
+            Action a2 = new Action(2, "action2", Action2, 1);
+
+            Transition t = a1.AddTransition(3, "transition", a2, VariableIsSet);
+            t.AddVariable(0);
+            t.IsPure = true;
+            t.delayBetweenEvaluation = 3600;
+
+            pn.AddAction(a1, true);
+            pn.AddAction(a2, false);
+
+            string stdout, stderr;
+            CompilerUtility.InvokeAndRedirectOutput(() => {
+                pn.Run();
+
+                // WHEN the variable the transition depends on is changed from outside of the petri net
+                pn.GetVariable(0).Value = 1;
+                pn.Join();
+            }, out stdout, out stderr);
+
+            // THEN the transition is crossed without waiting for its next evaluation
+            Assert.AreEqual("Action1!\nAction2!\n", stdout);
+            Assert.IsEmpty(stderr);
+        }
+
+        public static bool ResultIsOne(System.Int32 result)
+        {
+            ++evaluations;
+            return result == 1;
+        }
+
+        [Test(), Timeout(10000)]
+        public void TestRuntimeResultOnlyTransitionIsEvaluatedOnce()
+        {
+            // GIVEN a petri net whose only transition depends on the action result, which does not fulfill it
+            PetriNet pn = new PetriNet("Test");
+
+            Action a1 = new Action(1, "action1", Action1, 1);
+            Action a2 = new Action(2, "action2", Action2, 1);
+
+            Transition t = a1.AddTransition(3, "transition", a2, ResultIsOne);
+            t.IsPure = true;
+            t.delayBetweenEvaluation = 0.001;
+
+            pn.AddAction(a1, true);
+            pn.AddAction(a2, false);
+            evaluations = 0;
+
+            // WHEN the petri net is executed
+            string stdout, stderr;
+            CompilerUtility.InvokeAndRedirectOutput(() => {
+                pn.Run();
+                pn.Join();
+            }, out stdout, out stderr);
+
+            // THEN the transition is evaluated once, and the execution ends instead of waiting forever
+            Assert.AreEqual("Action1!\n", stdout);
+            Assert.AreEqual(1, evaluations);
+            Assert.IsEmpty(stderr);
+        }
+
+        public static System.Int32 ReturnOne()
+        {
+            System.Console.WriteLine("ReturnOne!");
+            return 1;
+        }
+
+        [Test(), Timeout(10000)]
+        public void TestRuntimeExpectedResultIsLookedUp()
+        {
+            // GIVEN a petri net whose transitions compare the action result with constants
+            PetriNet pn = new PetriNet("Test");
+
+            Action a1 = new Action(1, "action1", ReturnOne, 1);
+            Action a2 = new Action(2, "action2", Action2, 1);
+            Action a3 = new Action(3, "action3", Action3, 1);
+
+            Transition t1 = a1.AddTransition(4, "transition1", a2, ResultIsOne);
+            t1.IsPure = true;
+            t1.SetExpectedResult(1);
+            Transition t2 = a1.AddTransition(5, "transition2", a3, ResultIsOne);
+            t2.IsPure = true;
+            t2.SetExpectedResult(2);
+
+            pn.AddAction(a1, true);
+            pn.AddAction(a2, false);
+            pn.AddAction(a3, false);
+            evaluations = 0;
+
+            // WHEN the petri net is executed
+            string stdout, stderr;
+            CompilerUtility.InvokeAndRedirectOutput(() => {
+                pn.Run();
+                pn.Join();
+            }, out stdout, out stderr);
+
+            // THEN only the transition expecting the result is crossed, without evaluating any condition
+            Assert.AreEqual("ReturnOne!\nAction2!\n", stdout);
+            Assert.AreEqual(0, evaluations);
+            Assert.IsEmpty(stderr);
+        }
+
+        public static bool FourthEvaluation(System.Int32 result)
+        {
+            return ++evaluations >= 4;
+        }
+
+        [Test(), Timeout(10000)]
+        public void TestRuntimePolledTransitionWaitsForItsDelay()
+        {
+            // GIVEN a petri net with a polled transition fulfilled on its fourth evaluation
+            PetriNet pn = new PetriNet("Test");
+
+            Action a1 = new Action(1, "action1", Action1, 1);
+            Action a2 = new Action(2, "action2", Action2, 1);
+
+            Transition t = a1.AddTransition(3, "transition", a2, FourthEvaluation);
+            t.delayBetweenEvaluation = 0.05;
+
+            pn.AddAction(a1, true);
+            pn.AddAction(a2, false);
+            evaluations = 0;
+
+            // WHEN the petri net is executed
+            var stopwatch = System.Diagnostics.Stopwatch.StartNew();
+            string stdout, stderr;
+            CompilerUtility.InvokeAndRedirectOutput(() => {
+                pn.Run();
+                pn.Join();
+            }, out stdout, out stderr);
+            stopwatch.Stop();
+
+            // THEN the transition is evaluated again only once its delay has elapsed
+            Assert.AreEqual("Action1!\nAction2!\n", stdout);
+            Assert.AreEqual(4, evaluations);
+            Assert.GreaterOrEqual(stopwatch.Elapsed.TotalSeconds, 0.15);
+        }
+
+        [Test(), Timeout(10000)]
+        public void TestRuntimeResetRunsAgain()
+        {
+            // GIVEN a petri net which has already been executed once
+            PetriNet pn = new PetriNet("Test");
+
+            Action a1 = new Action(1, "action1", Action1, 1);
+            Action a2 = new Action(2, "action2", Action2, 1);
+            Action a3 = new Action(3, "action3", Action3, 2);
+
+            a1.AddTransition(4, "transition1", a3, Transition2);
+            a2.AddTransition(5, "transition2", a3, Transition2);
+
+            pn.AddAction(a1, true);
+            pn.AddAction(a2, true);
+            pn.AddAction(a3, false);
+
+            pn.Run();
+            pn.Join();
+
+            // WHEN it is reset and executed again
+            string stdout, stderr;
+            CompilerUtility.InvokeAndRedirectOutput(() => {
+                pn.Reset();
+                pn.Run();
+                pn.Join();
+            }, out stdout, out stderr);
+
+            // THEN the whole execution happens again, the join waiting for both of its tokens
+            StringAssert.Contains("Action1!\n", stdout);
+            StringAssert.Contains("Action2!\n", stdout);
+            StringAssert.EndsWith("Action3!\n", stdout);
+            Assert.IsEmpty(stderr);
+        }
+
         [Test(), Repeat(10)]
         public void TestRuntimeActionProperties()
         {
@@ -147,5 +332,6 @@ namespace Petri.Test
 
 
         static volatile int counter;
+        static int evaluations;
     }
 }
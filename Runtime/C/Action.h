@@ -142,7 +142,8 @@ uint64_t PetriAction_getRequiredTokens(struct PetriAction *action);
 void PetriAction_setRequiredTokens(struct PetriAction *action, uint64_t requiredTokens);
 
 /**
- * Gets the current tokens count given to the Action by its preceding Actions.
+ * Gets the current tokens count given to the Action by its preceding Actions. The count is atomic,
+ * so it can be read while the net is running.
  * @return The current tokens count of the Action
  */
 uint64_t PetriAction_getCurrentTokens(struct PetriAction *action);
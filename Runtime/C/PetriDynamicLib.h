@@ -73,6 +73,15 @@ struct PetriNet *PetriDynamicLib_createPetriNet(struct PetriDynamicLib *lib);
  */
 struct PetriNet *PetriDynamicLib_createDebugPetriNet(struct PetriDynamicLib *lib);
 
+/**
+ * Creates a lightweight instance of the PetriNet contained in the dynamic library. The actions and transitions of the
+ * net are only created once per library, and shared by all of its instances along with their worker threads.
+ * The instance must be destroyed before the library.
+ * @param lib The dynamic library handle to extract the PetriNet from.
+ * @return The newly created PetriNet, or NULL if the lib is not load()ed.
+ */
+struct PetriNet *PetriDynamicLib_createPetriNetInstance(struct PetriDynamicLib *lib);
+
 /**
  * Returns the SHA-1 hash string that identifies the PetriNet contained in the library.
  * @param lib The dynamic library handle containing the PetriNet.
@@ -78,6 +78,22 @@ void PetriNet_addAction(struct PetriNet *pn, struct PetriAction *action, bool ac
  */
 bool PetriNet_isRunning(struct PetriNet *pn);
 
+/**
+ * Compiles the actions and transitions of the Petri net into the compact form it is executed on.
+ * This is done by PetriNet_run() if it has not been done before. Once frozen, no action can be added
+ * to the net anymore, and the actions and transitions must not be modified.
+ * @param pn The Petri Net to freeze
+ */
+void PetriNet_freeze(struct PetriNet *pn);
+
+/**
+ * Changes the maximum number of successive states a worker thread executes on its own, instead of
+ * adding each next state to the thread pool. 0 disables the chaining.
+ * @param pn The Petri Net to change
+ * @param depth The maximum length of a chain of states executed without the thread pool
+ */
+void PetriNet_setChainDepth(struct PetriNet *pn, uint64_t depth);
+
 /**
  * Starts the Petri net. It must not be already running. If no states are initially active, this is
  * a no-op.
@@ -92,6 +108,14 @@ void PetriNet_run(struct PetriNet *pn);
  */
 void PetriNet_stop(struct PetriNet *pn);
 
+/**
+ * Restores the initial state of a Petri net which is not running, so that it can be run again with
+ * the same actions, transitions and worker threads: the tokens of the actions are cleared, and the
+ * variables get back the values they had when the net was frozen.
+ * @param pn The Petri Net to reset.
+ */
+void PetriNet_reset(struct PetriNet *pn);
+
 /**
  * Blocks the calling thread until the Petri net has completed its whole execution.
  * @param pn The Petri Net to join.
@@ -99,14 +123,29 @@ void PetriNet_stop(struct PetriNet *pn);
 void PetriNet_join(struct PetriNet *pn);
 
 /**
- * Adds an Atomic variable designated by the specified id.
+ * Blocks the calling thread until the Petri net has completed its whole execution, or until the
+ * timeout expires.
+ * @param pn The Petri Net to join.
+ * @param usTimeout The maximum duration to wait for, in microseconds.
+ * @return true if the execution is over, false if the timeout has expired.
+ */
+bool PetriNet_joinFor(struct PetriNet *pn, uint64_t usTimeout);
+
+/**
+ * Adds an Atomic variable designated by the specified id. The variables are stored in a table
+ * indexed by their id, which should thus be small and dense. The ids from 65536 on are looked up
+ * in a slower sparse map instead.
  * @param pn The Petri Net to add the variable to.
  * @param id The id of the new Atomic variable.
  */
 void PetriNet_addVariable(struct PetriNet *pn, uint32_t id);
 
 /**
- * Gets a pointer to the value of the Atomic variable designated by the specified id.
+ * Gets a pointer to the value of the Atomic variable designated by the specified id. The value
+ * must only be accessed through it while holding the lock of the variable, see
+ * PetriNet_lockVariable, and must not be accessed at the same time by the lock-free operations of
+ * the C++ runtime, which the C code generator never uses. PetriNet_getVariableValue and
+ * PetriNet_setVariableValue access the value atomically, and do not need the lock.
  * @param pn The Petri Net that contains the variable.
  * @param id The id of the new Atomic variable.
  * @return A pointer to the value of the Atomic variable.
@@ -122,7 +161,8 @@ volatile int64_t *PetriNet_getVariable(struct PetriNet *pn, uint32_t id);
 int64_t PetriNet_getVariableValue(struct PetriNet *pn, uint32_t id);
 
 /**
- * Sets the value of the Atomic variable designated by the specified id to the given value.
+ * Sets the value of the Atomic variable designated by the specified id to the given value, and
+ * wakes up the transitions depending on it.
  * @param pn The Petri Net that contains the variable.
  * @param id The id of the new Atomic variable.
  * @param value The value of the Atomic variable.
@@ -138,7 +178,8 @@ void PetriNet_lockVariable(struct PetriNet *pn, uint32_t id);
 
 /**
  * Unlocks the Atomic variable designated by the specified id, provided it has already been locked.
- * The behavior is unspecified otherwise.
+ * The behavior is unspecified otherwise. As the variable may have been modified while it was
+ * locked, the transitions depending on it are woken up.
  * @param pn The Petri Net containing the variable to unlock.
  * @param id The id of the Atomic variable.
  */
@@ -118,6 +118,32 @@ uint64_t PetriTransition_getDelayBetweenEvaluation(struct PetriTransition *trans
  */
 void PetriTransition_setDelayBetweenEvaluation(struct PetriTransition *transition, uint64_t usDelay);
 
+/**
+ * Checks whether the condition of the PetriTransition is pure, i.e. whether it only depends on the
+ * result of the PetriAction 'previous' and on the variables added with PetriTransition_addVariable.
+ * A pure PetriTransition is only re-evaluated when one of these variables is changed, whereas the
+ * other ones are polled. Without any variable, it is evaluated only once.
+ * @param transition The PetriTransition instance to query.
+ * @return Whether the PetriTransition is pure.
+ */
+bool PetriTransition_isPure(struct PetriTransition *transition);
+
+/**
+ * Changes the purity of the PetriTransition.
+ * @param transition The PetriTransition instance to change.
+ * @param pure Whether the PetriTransition is pure.
+ */
+void PetriTransition_setPure(struct PetriTransition *transition, bool pure);
+
+/**
+ * Tells that the condition of the PetriTransition is the comparison of the result of the
+ * PetriAction 'previous' with the given value. The runtime then finds it by looking the result up
+ * instead of evaluating its condition, which must be consistent with this value.
+ * @param transition The PetriTransition instance to change.
+ * @param result The value of the result which fulfills the PetriTransition.
+ */
+void PetriTransition_setExpectedResult(struct PetriTransition *transition, Petri_actionResult_t result);
+
 /**
  * References the variable in the transition
  * @param transition The transition
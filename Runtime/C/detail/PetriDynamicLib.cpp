@@ -62,6 +62,15 @@ PetriNet *PetriDynamicLib_createDebugPetriNet(PetriDynamicLib *lib) {
     }
 }
 
+PetriNet *PetriDynamicLib_createPetriNetInstance(PetriDynamicLib *lib) {
+    try {
+        return new PetriNet{lib->lib->createInstance()};
+    } catch(std::exception const &e) {
+        std::cerr << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
 char const *PetriDynamicLib_getHash(PetriDynamicLib *lib) {
     return lib->lib->hash().c_str();
 }
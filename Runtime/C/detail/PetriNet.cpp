@@ -64,6 +64,14 @@ bool PetriNet_isRunning(PetriNet *pn) {
     return getPetriNet(pn).running();
 }
 
+void PetriNet_freeze(PetriNet *pn) {
+    getPetriNet(pn).freeze();
+}
+
+void PetriNet_setChainDepth(PetriNet *pn, uint64_t depth) {
+    getPetriNet(pn).setChainDepth(depth);
+}
+
 void PetriNet_run(PetriNet *pn) {
     getPetriNet(pn).run();
 }
@@ -72,24 +80,35 @@ void PetriNet_stop(PetriNet *pn) {
     getPetriNet(pn).stop();
 }
 
+void PetriNet_reset(PetriNet *pn) {
+    getPetriNet(pn).reset();
+}
+
 void PetriNet_join(PetriNet *pn) {
     getPetriNet(pn).join();
 }
 
+bool PetriNet_joinFor(PetriNet *pn, uint64_t usTimeout) {
+    return getPetriNet(pn).joinFor(std::chrono::microseconds(usTimeout));
+}
+
 void PetriNet_addVariable(PetriNet *pn, uint32_t id) {
     getPetriNet(pn).addVariable(id);
 }
 
 volatile int64_t *PetriNet_getVariable(PetriNet *pn, uint32_t id) {
-    return &getPetriNet(pn).getVariable(id).value();
+    static_assert(sizeof(std::atomic<std::int64_t>) == sizeof(int64_t), "The value of a variable must be usable as an int64_t!");
+    return reinterpret_cast<volatile int64_t *>(&getPetriNet(pn).getVariable(id).value().atomic());
 }
 
 int64_t PetriNet_getVariableValue(struct PetriNet *pn, uint32_t id) {
-    return *PetriNet_getVariable(pn, id);
+    return getPetriNet(pn).getVariable(id).load();
 }
 
 void PetriNet_setVariableValue(struct PetriNet *pn, uint32_t id, int64_t value) {
-    *PetriNet_getVariable(pn, id) = value;
+    auto &atomic = getPetriNet(pn).getVariable(id);
+    atomic.store(value);
+    atomic.notifyChange();
 }
 
 void PetriNet_lockVariable(PetriNet *pn, uint32_t id) {
@@ -97,7 +116,9 @@ void PetriNet_lockVariable(PetriNet *pn, uint32_t id) {
 }
 
 void PetriNet_unlockVariable(PetriNet *pn, uint32_t id) {
-    getPetriNet(pn).getVariable(id).getMutex().unlock();
+    auto &atomic = getPetriNet(pn).getVariable(id);
+    atomic.getMutex().unlock();
+    atomic.notifyChange();
 }
 
 char const *PetriNet_getName(PetriNet *pn) {
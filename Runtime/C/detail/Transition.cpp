@@ -84,6 +84,18 @@ void PetriTransition_setDelayBetweenEvaluation(PetriTransition *transition, uint
     getTransition(transition).setDelayBetweenEvaluation(std::chrono::microseconds(usDelay));
 }
 
+bool PetriTransition_isPure(struct PetriTransition *transition) {
+    return getTransition(transition).isPure();
+}
+
+void PetriTransition_setPure(struct PetriTransition *transition, bool pure) {
+    getTransition(transition).setPure(pure);
+}
+
+void PetriTransition_setExpectedResult(struct PetriTransition *transition, Petri_actionResult_t result) {
+    getTransition(transition).setExpectedResult(result);
+}
+
 void PetriTransition_addVariable(struct PetriTransition *transition, uint32_t id) {
     getTransition(transition).addVariable(id);
 }
@@ -72,6 +72,16 @@ namespace Petri.Runtime
             return new PetriNet(Interop.PetriDynamicLib.PetriDynamicLib_createPetriNet(Handle));
         }
 
+        /**
+         * Creates a lightweight instance of the PetriNet contained in the dynamic library, which
+         * shares its actions, transitions and worker threads with the other instances.
+         * @return The PetriNet object
+         */
+        public PetriNet CreateInstance()
+        {
+            return new PetriNet(Interop.PetriDynamicLib.PetriDynamicLib_createPetriNetInstance(Handle));
+        }
+
         /**
          * Creates the PetriDebug object according to the code contained in the dynamic library.
          * @return The PetriDebug object wrapped in a std::unique_ptr
@@ -21,6 +21,9 @@ namespace Petri.Runtime.Interop {
         [DllImport("PetriRuntime")]
         public static extern IntPtr PetriDynamicLib_createDebugPetriNet(IntPtr lib);
 
+        [DllImport("PetriRuntime")]
+        public static extern IntPtr PetriDynamicLib_createPetriNetInstance(IntPtr lib);
+
         [DllImport("PetriRuntime")]
         public static extern IntPtr PetriDynamicLib_getHash(IntPtr lib);
 
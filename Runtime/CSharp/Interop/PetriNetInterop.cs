@@ -21,15 +21,27 @@ namespace Petri.Runtime.Interop {
         [DllImport("PetriRuntime")]
         public static extern bool PetriNet_isRunning(IntPtr pn);
 
+        [DllImport("PetriRuntime")]
+        public static extern void PetriNet_freeze(IntPtr pn);
+
+        [DllImport("PetriRuntime")]
+        public static extern void PetriNet_setChainDepth(IntPtr pn, UInt64 depth);
+
         [DllImport("PetriRuntime")]
         public static extern void PetriNet_run(IntPtr pn);
 
         [DllImport("PetriRuntime")]
         public static extern void PetriNet_stop(IntPtr pn);
 
+        [DllImport("PetriRuntime")]
+        public static extern void PetriNet_reset(IntPtr pn);
+
         [DllImport("PetriRuntime")]
         public static extern void PetriNet_join(IntPtr pn);
 
+        [DllImport("PetriRuntime")]
+        public static extern bool PetriNet_joinFor(IntPtr pn, UInt64 usTimeout);
+
         [DllImport("PetriRuntime")]
         public static extern void PetriNet_addVariable(IntPtr pn, UInt32 id);
 
@@ -42,6 +42,15 @@ namespace Petri.Runtime.Interop {
         [DllImport("PetriRuntime")]
         public static extern void PetriTransition_setDelayBetweenEvaluation(IntPtr transition, UInt64 usDelay);
 
+        [DllImport("PetriRuntime")]
+        public static extern bool PetriTransition_isPure(IntPtr transition);
+
+        [DllImport("PetriRuntime")]
+        public static extern void PetriTransition_setPure(IntPtr transition, bool pure);
+
+        [DllImport("PetriRuntime")]
+        public static extern void PetriTransition_setExpectedResult(IntPtr transition, Int32 result);
+
         [DllImport("PetriRuntime")]
         public static extern void PetriTransition_addVariable(IntPtr transition, UInt32 id);
     }
@@ -78,6 +78,24 @@ namespace Petri.Runtime
             }
         }
 
+        /**
+         * Compiles the actions and transitions of the Petri net into the compact form it is executed on.
+         * This is done by Run() if it has not been done before. Once frozen, no action can be added to the net anymore.
+         */
+        public void Freeze()
+        {
+            Interop.PetriNet.PetriNet_freeze(Handle);
+        }
+
+        /**
+         * Changes the maximum number of successive states a worker thread executes on its own, instead of adding each next state to the thread pool.
+         * 0 disables the chaining.
+         */
+        public void SetChainDepth(UInt64 depth)
+        {
+            Interop.PetriNet.PetriNet_setChainDepth(Handle, depth);
+        }
+
         /**
          * Starts the Petri net. It must not be already running. If no states are initially active, this is a no-op.
          */
@@ -95,6 +113,15 @@ namespace Petri.Runtime
             Interop.PetriNet.PetriNet_stop(Handle);
         }
 
+        /**
+         * Restores the initial state of a Petri net which is not running, so that it can be run again with the same actions, transitions and worker threads.
+         * The tokens of the actions are cleared, and the variables get back the values they had when the net was frozen.
+         */
+        public void Reset()
+        {
+            Interop.PetriNet.PetriNet_reset(Handle);
+        }
+
         /**
          * Blocks the calling thread until the Petri net has completed its whole execution.
          */
@@ -103,6 +130,16 @@ namespace Petri.Runtime
             Interop.PetriNet.PetriNet_join(Handle);
         }
 
+        /**
+         * Blocks the calling thread until the Petri net has completed its whole execution, or until the timeout expires.
+         * @param timeout The maximum duration to wait for, in seconds.
+         * @return true if the execution is over, false if the timeout has expired.
+         */
+        public bool JoinFor(double timeout)
+        {
+            return Interop.PetriNet.PetriNet_joinFor(Handle, (UInt64)(timeout * 1.0e6));
+        }
+
         /**
          * Adds an Atomic variable designated by the specified id.
          * @param id the id of the new Atomic variable
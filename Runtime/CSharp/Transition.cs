@@ -125,6 +125,28 @@ namespace Petri.Runtime
             }
         }
 
+        /**
+         * Whether the condition of the Transition is pure, i.e. only depends on the result of the Action 'previous' and on the variables added with AddVariable().
+         * A pure Transition is only re-evaluated when one of these variables is changed, whereas the other ones are polled.
+         * Without any variable, it is evaluated only once.
+         */
+        public bool IsPure {
+            get {
+                return Interop.Transition.PetriTransition_isPure(Handle);
+            }
+            set {
+                Interop.Transition.PetriTransition_setPure(Handle, value);
+            }
+        }
+
+        /**
+         * Tells that the condition of the Transition is the comparison of the result of the Action 'previous' with the given value.
+         * The runtime then finds it by looking the result up instead of evaluating its condition, which must be consistent with this value.
+         */
+        public void SetExpectedResult(Int32 result) {
+            Interop.Transition.PetriTransition_setExpectedResult(Handle, result);
+        }
+
         public void AddVariable(UInt32 id) {
             Interop.Transition.PetriTransition_addVariable(Handle, id);
         }
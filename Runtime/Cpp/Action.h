@@ -32,30 +32,37 @@
 
 #include "Callable.h"
 #include "Transition.h"
+#include <atomic>
 #include <list>
-#include <mutex>
 
 namespace Petri {
 
     using namespace std::chrono_literals;
 
+    class InternedName;
     class PetriNet;
 
-    using ActionCallableBase = CallableBase<actionResult_t>;
-    using ParametrizedActionCallableBase = CallableBase<actionResult_t, PetriNet &>;
+    using ActionCallable = InlineCallable<actionResult_t()>;
+    using ParametrizedActionCallable = InlineCallable<actionResult_t(PetriNet &)>;
+    using ActionCallableBase [[deprecated("Use ActionCallable instead")]] = ActionCallable;
+    using ParametrizedActionCallableBase [[deprecated("Use ParametrizedActionCallable instead")]] = ParametrizedActionCallable;
 
     template <typename CallableType>
     auto make_action_callable(CallableType &&c) {
-        return Callable<CallableType, actionResult_t>(c);
+        return ActionCallable(std::forward<CallableType>(c));
     }
 
     template <typename CallableType>
     auto make_param_action_callable(CallableType &&c) {
-        return Callable<CallableType, actionResult_t, PetriNet &>(c);
+        return ParametrizedActionCallable(std::forward<CallableType>(c));
     }
 
     /**
      * A state composing a PetriNet.
+     * On a 64 bit platform with libstdc++, an action added to a net takes 72 bytes in the list of
+     * the actions of the net and 176 bytes of internals in its arena, plus 24 bytes for each
+     * transition leading to it. Its name is interned in the table shared by all of the nets, and its
+     * first Entity::InlineVariables variables are stored inside of it.
      */
     class Action : public Entity {
         friend class PetriNet;
@@ -75,7 +82,7 @@ namespace Petri {
          * @param requiredTokens The number of tokens that must be inside the active action for it
          * to execute.
          */
-        Action(uint64_t id, std::string const &name, ActionCallableBase const &action, size_t requiredTokens);
+        Action(uint64_t id, std::string const &name, ActionCallable const &action, size_t requiredTokens);
         Action(uint64_t id, std::string const &name, actionResult_t (*action)(), size_t requiredTokens);
 
         /**
@@ -86,7 +93,7 @@ namespace Petri {
          * @param requiredTokens The number of tokens that must be inside the active action for it
          * to execute.
          */
-        Action(uint64_t id, std::string const &name, ParametrizedActionCallableBase const &action, size_t requiredTokens);
+        Action(uint64_t id, std::string const &name, ParametrizedActionCallable const &action, size_t requiredTokens);
         Action(uint64_t id, std::string const &name, actionResult_t (*action)(PetriNet &), size_t requiredTokens);
 
         Action(Action &&) noexcept;
@@ -105,9 +112,9 @@ namespace Petri {
         Transition &addTransition(uint64_t id,
                                   std::string const &name,
                                   Action &next,
-                                  ParametrizedTransitionCallableBase const &cond);
+                                  ParametrizedTransitionCallable const &cond);
         Transition &
-        addTransition(uint64_t id, std::string const &name, Action &next, TransitionCallableBase const &cond);
+        addTransition(uint64_t id, std::string const &name, Action &next, TransitionCallable const &cond);
         Transition &addTransition(uint64_t id, std::string const &name, Action &next, bool (*cond)(actionResult_t));
         Transition &
         addTransition(uint64_t id, std::string const &name, Action &next, bool (*cond)(PetriNet &, actionResult_t));
@@ -124,20 +131,20 @@ namespace Petri {
          * invoke this method!
          * @return The Callable of the Action
          */
-        ParametrizedActionCallableBase &action() noexcept;
+        ParametrizedActionCallable const &action() const noexcept;
 
         /**
          * Changes the Callable associated to the Action
          * @param action The Callable which will be copied and put in the Action
          */
-        void setAction(ActionCallableBase const &action);
+        void setAction(ActionCallable const &action);
         void setAction(actionResult_t (*action)());
 
         /**
          * Changes the Callable associated to the Action
          * @param action The Callable which will be copied and put in the Action
          */
-        void setAction(ParametrizedActionCallableBase const &action);
+        void setAction(ParametrizedActionCallable const &action);
         void setAction(actionResult_t (*action)(PetriNet &));
 
         /**
@@ -154,11 +161,21 @@ namespace Petri {
         void setRequiredTokens(std::size_t requiredTokens) noexcept;
 
         /**
-         * Gets the current tokens count given to the Action by its preceding Actions.
+         * Gets the current tokens count given to the Action by its preceding Actions. The count is
+         * atomic, so it can be read while the net is running. The instances of a PetriNetPrototype
+         * have their own counts, which are not reflected here.
          * @return The current tokens count of the Action
          */
         std::size_t currentTokens() noexcept;
 
+        /**
+         * Gets the number of currently active states of the Action, i.e. of executions of the
+         * Action which have not crossed any of its transitions yet. The count is atomic, so it
+         * can be read while the net is running.
+         * @return The active states count of the Action
+         */
+        std::size_t activations() noexcept;
+
         /**
          * Returns the name of the Action.
          * @return The name of the Action
@@ -169,21 +186,35 @@ namespace Petri {
          * Sets the name of the Action
          * @param name The name of the Action
          */
-        void setName(std::string const &name) noexcept(std::is_nothrow_move_constructible<std::string>::value);
+        void setName(std::string const &name);
+
+        using TransitionList = std::list<Transition, ArenaAllocator<Transition>>;
 
         /**
          * Returns the transitions exiting the Action.
          */
-        std::list<Transition> const &transitions() const noexcept;
+        TransitionList const &transitions() const noexcept;
 
     private:
-        std::size_t &currentTokensRef() noexcept;
-        std::mutex &tokensMutex() noexcept;
+        // Creates an action whose internals are allocated in the arena of its net
+        Action(uint64_t id, char const *name, ParametrizedActionCallable const &action, size_t requiredTokens, Arena &arena);
+
+        // Moves the Action into the arena of the net it is added to, unless it is already linked
+        // to other actions, in which case it stays on the heap
+        void moveTo(Arena &arena);
+
+        std::atomic_size_t &currentTokensRef() noexcept;
+        std::atomic_size_t &activationsRef() noexcept;
 
         Transition &addTransition(Transition t);
+        // The name is already interned in the NameTable
+        Transition &addTransition(uint64_t id, InternedName &&name, Action &next, ParametrizedTransitionCallable const &cond);
 
         struct Internals;
-        std::unique_ptr<Internals> _internals;
+        struct InternalsDeleter {
+            void operator()(Internals *internals) const noexcept;
+        };
+        std::unique_ptr<Internals, InternalsDeleter> _internals;
     };
 }
 
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  Arena.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#ifndef Petri_Arena_h
+#define Petri_Arena_h
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Petri {
+
+    /**
+     * A monotonic memory resource, owned by a PetriNet, from which the structure of the net is
+     * allocated: its actions, transitions and the lists linking them. The memory is taken from
+     * chunks of growing size, and is never given back before the whole arena is released at once,
+     * so that the entities of a net are laid out next to each other and destroying a big net does
+     * not free them one by one. The objects created in the arena still have to be destroyed by
+     * their owner.
+     * An arena is not thread-safe: the structure of a net is built by a single thread.
+     */
+    class Arena {
+    public:
+        Arena() = default;
+        ~Arena() {
+            this->release();
+        }
+
+        Arena(Arena const &) = delete;
+        Arena &operator=(Arena const &) = delete;
+
+        /**
+         * Allocates a block of memory, which stays valid until the arena is released.
+         * @param size The size of the block
+         * @param alignment The alignment of the block, which must be a power of 2
+         * @return The allocated block
+         */
+        void *allocate(std::size_t size, std::size_t alignment) {
+            auto const address = (reinterpret_cast<std::uintptr_t>(_cursor) + alignment - 1) & ~(alignment - 1);
+            if(_cursor == nullptr || address + size > reinterpret_cast<std::uintptr_t>(_end)) {
+                return this->grow(size, alignment);
+            }
+            _cursor = reinterpret_cast<unsigned char *>(address + size);
+            return reinterpret_cast<void *>(address);
+        }
+
+        /**
+         * Constructs an object in the arena, which must then be destroyed without being deleted.
+         * @param args The arguments of the constructor of the object
+         * @return The new object
+         */
+        template <typename T, typename... Args>
+        T *create(Args &&... args) {
+            return new(this->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        /**
+         * Gives all of the memory of the arena back to the system, which invalidates every block
+         * allocated from it.
+         */
+        void release() noexcept;
+
+        /**
+         * Returns the total size of the chunks currently held by the arena.
+         * @return The size of the arena, in bytes
+         */
+        std::size_t capacity() const noexcept {
+            return _capacity;
+        }
+
+    private:
+        // Allocates a new chunk large enough for the block, and returns the block
+        void *grow(std::size_t size, std::size_t alignment);
+
+        struct Chunk {
+            Chunk *previous;
+        };
+
+        Chunk *_chunks = nullptr;
+        unsigned char *_cursor = nullptr;
+        unsigned char *_end = nullptr;
+        std::size_t _capacity = 0;
+    };
+
+    /**
+     * A standard allocator taking its memory from an Arena, or from the global heap when it is not
+     * given any arena. The containers of an entity which is created out of any net thus use the
+     * heap, and the copies of a container always do, as they may outlive the arena.
+     */
+    template <typename T>
+    class ArenaAllocator {
+        template <typename U>
+        friend class ArenaAllocator;
+
+    public:
+        using value_type = T;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        ArenaAllocator(Arena *arena = nullptr) noexcept
+                : _arena(arena) {}
+
+        template <typename U>
+        ArenaAllocator(ArenaAllocator<U> const &other) noexcept
+                : _arena(other._arena) {}
+
+        T *allocate(std::size_t n) {
+            if(_arena) {
+                return static_cast<T *>(_arena->allocate(n * sizeof(T), alignof(T)));
+            }
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *p, std::size_t) noexcept {
+            if(!_arena) {
+                ::operator delete(p);
+            }
+        }
+
+        ArenaAllocator select_on_container_copy_construction() const noexcept {
+            return ArenaAllocator();
+        }
+
+        Arena *arena() const noexcept {
+            return _arena;
+        }
+
+        template <typename U>
+        bool operator==(ArenaAllocator<U> const &other) const noexcept {
+            return _arena == other._arena;
+        }
+        template <typename U>
+        bool operator!=(ArenaAllocator<U> const &other) const noexcept {
+            return _arena != other._arena;
+        }
+
+    private:
+        Arena *_arena;
+    };
+}
+
+#endif
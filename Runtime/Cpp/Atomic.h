@@ -31,31 +31,252 @@
 #define Petri_Atomic_h
 
 #include "PetriUtils.h"
+#include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 namespace Petri {
 
+    /**
+     * An object which wants to be told when the value of an Atomic variable may have changed, such
+     * as a state waiting for one of its transitions to become fulfilled.
+     */
+    class AtomicObserver {
+    public:
+        /**
+         * Called whenever one of the observed Atomic variables may have been modified. This may be
+         * invoked from any thread, and must not try to lock any Atomic variable.
+         */
+        virtual void atomicChanged() = 0;
+
+    protected:
+        ~AtomicObserver() = default;
+    };
+
     class Atomic {
     public:
+        /**
+         * A reference to the value of an Atomic variable, as returned by Atomic::value(). It is
+         * read and modified like an std::int64_t &, by the code holding the lock of the variable.
+         * Each read and write is atomic though, so that it does not race with the lock-free
+         * operations of the entities which do not lock the variable. A compound assignment or an
+         * increment is a read followed by a write, and is not atomic as a whole.
+         */
+        class Value {
+        public:
+            explicit Value(std::atomic<std::int64_t> &value) noexcept
+                    : _value(value) {}
+
+            Value(Value const &) = default;
+
+            Value &operator=(Value const &value) noexcept {
+                return *this = static_cast<std::int64_t>(value);
+            }
+
+            Value &operator=(std::int64_t value) noexcept {
+                _value.store(value, std::memory_order_relaxed);
+                return *this;
+            }
+
+            operator std::int64_t() const noexcept {
+                return _value.load(std::memory_order_relaxed);
+            }
+
+            Value &operator+=(std::int64_t value) noexcept {
+                return *this = *this + value;
+            }
+            Value &operator-=(std::int64_t value) noexcept {
+                return *this = *this - value;
+            }
+            Value &operator*=(std::int64_t value) noexcept {
+                return *this = *this * value;
+            }
+            Value &operator/=(std::int64_t value) noexcept {
+                return *this = *this / value;
+            }
+            Value &operator%=(std::int64_t value) noexcept {
+                return *this = *this % value;
+            }
+            Value &operator&=(std::int64_t value) noexcept {
+                return *this = *this & value;
+            }
+            Value &operator|=(std::int64_t value) noexcept {
+                return *this = *this | value;
+            }
+            Value &operator^=(std::int64_t value) noexcept {
+                return *this = *this ^ value;
+            }
+            Value &operator<<=(std::int64_t value) noexcept {
+                return *this = *this << value;
+            }
+            Value &operator>>=(std::int64_t value) noexcept {
+                return *this = *this >> value;
+            }
+
+            Value &operator++() noexcept {
+                return *this += 1;
+            }
+            Value &operator--() noexcept {
+                return *this -= 1;
+            }
+            std::int64_t operator++(int) noexcept {
+                std::int64_t value = *this;
+                *this = value + 1;
+                return value;
+            }
+            std::int64_t operator--(int) noexcept {
+                std::int64_t value = *this;
+                *this = value - 1;
+                return value;
+            }
+
+            /**
+             * Returns the storage of the value, which is an atomic 64 bits integer.
+             */
+            std::atomic<std::int64_t> &atomic() const noexcept {
+                return _value;
+            }
+
+        private:
+            std::atomic<std::int64_t> &_value;
+        };
+
         Atomic()
                 : _value(0) {}
 
-        auto &value() noexcept {
-            return _value;
+        /**
+         * Returns a reference to the value of the variable, to be read and modified while holding
+         * the lock of the variable.
+         * @return The value of the variable
+         */
+        Value value() noexcept {
+            return Value(_value);
+        }
+
+        // The following operations access the value atomically, without locking the variable. They
+        // are meant for the entities whose only access to the variable is a single read or update,
+        // and which thus do not need to lock it. An update made this way may be overwritten by an
+        // entity modifying the variable while holding its lock.
+
+        /**
+         * Atomically reads the value of the variable.
+         * @return The value of the variable
+         */
+        std::int64_t load() const noexcept {
+            return _value.load();
+        }
+
+        /**
+         * Atomically changes the value of the variable.
+         * @param value The new value of the variable
+         */
+        void store(std::int64_t value) noexcept {
+            _value.store(value);
+        }
+
+        /**
+         * Atomically adds a value to the variable.
+         * @param delta The value to add
+         * @return The value of the variable before the addition
+         */
+        std::int64_t fetchAdd(std::int64_t delta) noexcept {
+            return _value.fetch_add(delta);
+        }
+
+        /**
+         * Atomically replaces the value of the variable if it is equal to an expected one.
+         * @param expected The expected value, which is updated with the current value of the
+         * variable if they differ
+         * @param desired The new value of the variable
+         * @return Whether the value of the variable has been replaced
+         */
+        bool compareExchange(std::int64_t &expected, std::int64_t desired) noexcept {
+            return _value.compare_exchange_strong(expected, desired);
         }
 
         auto getLock() noexcept(
-        std::is_nothrow_constructible<std::unique_lock<std::mutex>, std::mutex &, std::defer_lock_t>::value) {
-            return std::unique_lock<std::mutex>{_mutex, std::defer_lock};
+        std::is_nothrow_constructible<std::unique_lock<std::shared_timed_mutex>, std::shared_timed_mutex &, std::defer_lock_t>::value) {
+            return std::unique_lock<std::shared_timed_mutex>{_mutex, std::defer_lock};
+        }
+
+        /**
+         * Returns an unlocked shared lock of the variable, which allows several readers to hold it
+         * at once but no writer.
+         */
+        auto getSharedLock() noexcept(
+        std::is_nothrow_constructible<std::shared_lock<std::shared_timed_mutex>, std::shared_timed_mutex &, std::defer_lock_t>::value) {
+            return std::shared_lock<std::shared_timed_mutex>{_mutex, std::defer_lock};
         }
 
         auto &getMutex() noexcept {
             return _mutex;
         }
 
+        /**
+         * Wakes up the observers of the variable, i.e. the transitions whose condition depends on
+         * it. The runtime calls it after each Action using the variable has been executed. Code
+         * modifying the variable from outside of the petri net must call it after the modification,
+         * otherwise the transitions depending on it will not see the new value until they are
+         * re-evaluated for another reason.
+         */
+        void notifyChange() {
+            ++_version;
+            std::lock_guard<std::mutex> lk(_observersMutex);
+            for(auto observer : _observers) {
+                observer->atomicChanged();
+            }
+        }
+
+        /**
+         * The modification counter of the variable, incremented by each call to notifyChange(). A
+         * condition which only depends on variables whose counters have not changed since its last
+         * evaluation does not need to be evaluated again.
+         * @return The current value of the counter
+         */
+        std::uint64_t version() const noexcept {
+            return _version;
+        }
+
+        /**
+         * Registers an observer, which will be notified by each subsequent call to notifyChange().
+         * @param observer The observer to register
+         */
+        void addObserver(AtomicObserver &observer) {
+            std::lock_guard<std::mutex> lk(_observersMutex);
+            _observers.push_back(&observer);
+        }
+
+        /**
+         * Makes room for a number of observers, so that registering up to that many of them at once
+         * does not allocate any memory.
+         * @param count The number of observers
+         */
+        void reserveObservers(std::size_t count) {
+            std::lock_guard<std::mutex> lk(_observersMutex);
+            _observers.reserve(count);
+        }
+
+        /**
+         * Unregisters an observer previously added with addObserver().
+         * @param observer The observer to unregister
+         */
+        void removeObserver(AtomicObserver &observer) {
+            std::lock_guard<std::mutex> lk(_observersMutex);
+            auto it = std::find(_observers.begin(), _observers.end(), &observer);
+            if(it != _observers.end()) {
+                _observers.erase(it);
+            }
+        }
+
     private:
-        std::int64_t _value;
-        std::mutex _mutex;
+        std::atomic<std::int64_t> _value;
+        std::shared_timed_mutex _mutex;
+        std::atomic<std::uint64_t> _version = {0};
+
+        std::vector<AtomicObserver *> _observers;
+        std::mutex _observersMutex;
     };
 }
 
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  BuildBenchmark.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Measures the time taken to construct, freeze and destroy a large petri net: when its actions and
+// transitions are added one by one as the generated fill() used to do, when they are added in a
+// single pass from constant tables by PetriNet::build(), and when the tables are lowered directly
+// as for a StaticPetriNet. The global operator new is replaced so as to count the heap allocations
+// made while the net is constructed, and their size per action or transition.
+
+#include "../Action.h"
+#include "../Atomic.h"
+#include "../PetriNet.h"
+#include "../StaticPetriNet.h"
+#include "../Transition.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <new>
+#include <vector>
+
+namespace {
+    std::atomic_long allocations = {0};
+    std::atomic_long allocatedBytes = {0};
+
+    void *allocate(std::size_t size) {
+        ++allocations;
+        allocatedBytes += size;
+        if(void *p = std::malloc(size ? size : 1)) {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    using namespace Petri;
+    using ClockType = std::chrono::steady_clock;
+
+    constexpr std::uint32_t Actions = 50'000;
+    constexpr std::uint_fast32_t Variable = 0;
+
+    actionResult_t action(PetriNet &) {
+        return 0;
+    }
+
+    bool condition(PetriNet &pn, actionResult_t) {
+        return pn.getVariable(Variable).value() == 0;
+    }
+
+    // Exposes the constructor lowering the tables, which StaticPetriNet only reaches with
+    // compile-time tables
+    struct LoweredPetriNet : PetriNet {
+        LoweredPetriNet(StaticNet const &net)
+                : PetriNet("Benchmark", net) {}
+    };
+
+    // A chain of actions, each one depending on the variable of the net
+    struct Tables {
+        Tables() {
+            for(std::uint32_t i = 0; i < Actions; ++i) {
+                actionNames.push_back("Root_Action" + std::to_string(i));
+                transitionNames.push_back("Transition" + std::to_string(i));
+            }
+            for(std::uint32_t i = 0; i < Actions; ++i) {
+                auto const transitions = static_cast<std::uint32_t>(this->transitions.size());
+                if(i + 1 < Actions) {
+                    this->transitions.push_back(
+                    {Actions + i, transitionNames[i].c_str(), i + 1, &condition, true, false, 0, 1, 2});
+                }
+                actions.push_back({i, actionNames[i].c_str(), &action, 1, i == 0, transitions,
+                                   static_cast<std::uint32_t>(this->transitions.size()), 0, 1});
+            }
+            net = {actions.data(), Actions, transitions.data(), static_cast<std::uint32_t>(transitions.size()),
+                   variables, 2, &Variable, 1};
+        }
+
+        std::vector<std::string> actionNames, transitionNames;
+        std::vector<StaticAction> actions;
+        std::vector<StaticTransition> transitions;
+        StaticVariable variables[2] = {{Variable, VariableAccess::Exclusive}, {Variable, VariableAccess::Shared}};
+        StaticNet net;
+    };
+
+    std::unique_ptr<PetriNet> addOneByOne() {
+        auto pn = std::make_unique<PetriNet>("Benchmark");
+        pn->addVariable(Variable);
+
+        std::vector<Action *> actions;
+        for(std::uint32_t i = 0; i < Actions; ++i) {
+            actions.push_back(&pn->addAction(Action(i, "Root_Action" + std::to_string(i), &action, 1), i == 0));
+            actions.back()->addVariable(Variable);
+        }
+        for(std::uint32_t i = 0; i + 1 < Actions; ++i) {
+            auto &t = actions[i]->addTransition(Actions + i, "Transition" + std::to_string(i), *actions[i + 1], &condition);
+            t.setPure(true);
+            t.addVariable(Variable, VariableAccess::Shared);
+        }
+
+        return pn;
+    }
+
+    template <typename Create>
+    void measure(char const *name, Create &&create) {
+        auto const allocationsAtStart = allocations.load();
+        auto const bytesAtStart = allocatedBytes.load();
+        auto const start = ClockType::now();
+        auto pn = create();
+        auto const built = ClockType::now();
+        auto const count = allocations - allocationsAtStart;
+        auto const bytes = double(allocatedBytes - bytesAtStart) / (2 * Actions - 1);
+        pn->freeze();
+        auto const frozen = ClockType::now();
+        pn.reset();
+        auto const destroyed = ClockType::now();
+
+        auto ms = [](ClockType::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        std::printf("%-16s %10.1fms %12ld %12.0f %10.1fms %10.1fms\n", name, ms(built - start), count, bytes,
+                    ms(frozen - built), ms(destroyed - frozen));
+    }
+}
+
+int main() {
+    Tables tables;
+
+    std::printf("%-16s %12s %12s %12s %12s %12s\n", "", "construction", "allocations", "bytes/entity", "freeze",
+                "destruction");
+    measure("addAction()", []() { return addOneByOne(); });
+    measure("build()", [&tables]() {
+        auto pn = std::make_unique<PetriNet>("Benchmark");
+        pn->build(tables.net);
+        return pn;
+    });
+    measure("static tables", [&tables]() { return std::make_unique<LoweredPetriNet>(tables.net); });
+
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  ChainBenchmark.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Measures the cost of a state on long sequential chains, where each state enables exactly one
+// next state, for several chain depths: 0 adds each next state to the thread pool, while the other
+// ones let the worker execute up to this number of states in a row.
+
+#include "../Action.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    using ClockType = std::chrono::steady_clock;
+
+    constexpr int RingSize = 8;
+    constexpr long Laps = 50'000;
+
+    long laps;
+
+    double run(std::size_t depth) {
+        Petri::PetriNet pn("Benchmark");
+        pn.setChainDepth(depth);
+
+        // A ring of actions, whose last one goes back to the first one until enough laps are done
+        std::vector<Petri::Action *> ring;
+        for(int i = 0; i < RingSize; ++i) {
+            auto callable = Petri::make_action_callable([i]() {
+                if(i != RingSize - 1) {
+                    return Petri::actionResult_t(0);
+                }
+                return Petri::actionResult_t(++laps < Laps ? 0 : 1);
+            });
+            ring.push_back(&pn.addAction(Petri::Action(i, "Ring" + std::to_string(i), callable, 1), i == 0));
+        }
+        auto &end = pn.addAction(Petri::Action(RingSize, "End", Petri::make_action_callable([]() {
+                                                   return Petri::actionResult_t(0);
+                                               }),
+                                               1));
+
+        for(int i = 0; i < RingSize; ++i) {
+            auto &t = ring[i]->addTransition(RingSize + 1 + i,
+                                             "",
+                                             *ring[(i + 1) % RingSize],
+                                             Petri::make_transition_callable([](Petri::actionResult_t r) { return r == 0; }));
+            t.setPure(true);
+            t.setExpectedResult(0);
+        }
+        auto &t = ring.back()->addTransition(2 * RingSize + 1,
+                                             "",
+                                             end,
+                                             Petri::make_transition_callable([](Petri::actionResult_t r) { return r == 1; }));
+        t.setPure(true);
+        t.setExpectedResult(1);
+
+        laps = 0;
+        pn.freeze();
+        auto const start = ClockType::now();
+        pn.run();
+        pn.join();
+        auto const elapsed = std::chrono::duration<double, std::nano>(ClockType::now() - start).count();
+
+        return elapsed / (Laps * RingSize + 1);
+    }
+}
+
+int main() {
+    std::printf("%-12s %18s\n", "chain depth", "time per state");
+    for(std::size_t depth : {0, 1, 4, 16, 64, 1024}) {
+        std::printf("%-12zu %16.0fns\n", depth, run(depth));
+    }
+
+    return 0;
+}
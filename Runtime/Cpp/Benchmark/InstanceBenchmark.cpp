@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+//
+//  InstanceBenchmark.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Measures the memory taken by each instance of a petri net, when every instance is a whole net
+// built from scratch as PetriDynamicLib::create() does, and when the instances are created from a
+// shared PetriNetPrototype. The global operator new is replaced so as to count the bytes allocated
+// by the whole process. The instances created from the prototype are then all run concurrently.
+
+#include "../Action.h"
+#include "../Atomic.h"
+#include "../PetriNet.h"
+#include "../PetriNetPrototype.h"
+#include "../Transition.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+    // The size of each block is stored in front of it, so that the freed bytes are counted too
+    constexpr std::size_t Header = alignof(std::max_align_t);
+    std::atomic_long liveBytes = {0};
+
+    void *allocate(std::size_t size) {
+        if(auto p = static_cast<unsigned char *>(std::malloc(size + Header))) {
+            *reinterpret_cast<std::size_t *>(p) = size;
+            liveBytes += size;
+            return p + Header;
+        }
+        throw std::bad_alloc();
+    }
+
+    void deallocate(void *p) noexcept {
+        if(p) {
+            auto block = static_cast<unsigned char *>(p) - Header;
+            liveBytes -= *reinterpret_cast<std::size_t *>(block);
+            std::free(block);
+        }
+    }
+}
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+void operator delete(void *p) noexcept {
+    deallocate(p);
+}
+void operator delete[](void *p) noexcept {
+    deallocate(p);
+}
+void operator delete(void *p, std::size_t) noexcept {
+    deallocate(p);
+}
+void operator delete[](void *p, std::size_t) noexcept {
+    deallocate(p);
+}
+
+namespace {
+    using ClockType = std::chrono::steady_clock;
+
+    constexpr int RingSize = 16;
+    constexpr std::int64_t Laps = 10;
+    constexpr std::size_t Instances = 10'000;
+
+    enum Variables { Laps_, Forked, Joined, Count };
+
+    // A ring of actions incrementing a variable of the net, which forks into two branches joined
+    // at the end once enough laps are done
+    std::unique_ptr<Petri::PetriNet> create() {
+        auto pn = std::make_unique<Petri::PetriNet>("Benchmark");
+        for(int v = 0; v < Count; ++v) {
+            pn->addVariable(v);
+        }
+
+        std::vector<Petri::Action *> ring;
+        for(int i = 0; i < RingSize; ++i) {
+            auto callable = Petri::make_param_action_callable([i](Petri::PetriNet &pn) {
+                if(i != RingSize - 1) {
+                    return Petri::actionResult_t(0);
+                }
+                return Petri::actionResult_t(++pn.getVariable(Laps_).value() < Laps ? 0 : 1);
+            });
+            auto &a = pn->addAction(Petri::Action(i, "Ring action number " + std::to_string(i), callable, 1), i == 0);
+            if(i == RingSize - 1) {
+                a.addVariable(Laps_);
+            }
+            ring.push_back(&a);
+        }
+
+        auto count = [](int variable) {
+            return Petri::make_param_action_callable([variable](Petri::PetriNet &pn) {
+                ++pn.getVariable(variable).value();
+                return Petri::actionResult_t(0);
+            });
+        };
+        auto &left = pn->addAction(Petri::Action(RingSize, "Left branch", count(Forked), 1));
+        left.addVariable(Forked);
+        auto &right = pn->addAction(Petri::Action(RingSize + 1, "Right branch", count(Forked), 1));
+        right.addVariable(Forked);
+        auto &join = pn->addAction(Petri::Action(RingSize + 2, "Join of the branches", count(Joined), 2));
+        join.addVariable(Joined);
+
+        auto result = [](Petri::actionResult_t expected) {
+            return Petri::make_transition_callable([expected](Petri::actionResult_t r) { return r == expected; });
+        };
+        std::uint64_t id = RingSize + 3;
+        for(int i = 0; i < RingSize; ++i) {
+            auto &t = ring[i]->addTransition(id++, "Next action of the ring", *ring[(i + 1) % RingSize], result(0));
+            t.setPure(true);
+            t.setExpectedResult(0);
+        }
+        for(auto branch : {&left, &right}) {
+            auto &t = ring.back()->addTransition(id++, "Fork of the branches", *branch, result(1));
+            t.setPure(true);
+            t.setExpectedResult(1);
+            branch->addTransition(id++, "Branch joined", join, result(0)).setPure(true);
+        }
+
+        return pn;
+    }
+}
+
+int main() {
+    // Each run prints the end of its execution
+    std::cout.setstate(std::ios::failbit);
+
+    // A whole net per instance
+    long before = liveBytes;
+    std::vector<std::unique_ptr<Petri::PetriNet>> nets;
+    for(std::size_t i = 0; i < Instances / 10; ++i) {
+        nets.push_back(create());
+        nets.back()->freeze();
+    }
+    double const perNet = double(liveBytes - before) / nets.size();
+    nets.clear();
+
+    // The instances of a prototype, before and after their first run
+    before = liveBytes;
+    Petri::PetriNetPrototype prototype(create());
+    long const shared = liveBytes - before;
+
+    before = liveBytes;
+    std::vector<std::unique_ptr<Petri::PetriNet>> instances;
+    for(std::size_t i = 0; i < Instances; ++i) {
+        instances.push_back(prototype.createInstance());
+    }
+    double const perInstance = double(liveBytes - before) / Instances;
+
+    auto const start = ClockType::now();
+    for(auto &instance : instances) {
+        instance->run();
+    }
+    bool ok = true;
+    for(auto &instance : instances) {
+        instance->join();
+        ok = ok && instance->getVariable(Laps_).value() == Laps && instance->getVariable(Forked).value() == 2 &&
+             instance->getVariable(Joined).value() == 1;
+    }
+    auto const elapsed = std::chrono::duration<double, std::milli>(ClockType::now() - start).count();
+    double const perRunInstance = double(liveBytes - before) / Instances;
+
+    std::printf("%-28s %10.0f bytes\n", "whole net", perNet);
+    std::printf("%-28s %10ld bytes\n", "prototype", shared);
+    std::printf("%-28s %10.0f bytes\n", "instance", perInstance);
+    std::printf("%-28s %10.0f bytes\n", "instance once run", perRunInstance);
+    std::printf("%zu instances run concurrently in %.0fms\n", Instances, elapsed);
+    std::printf("%s\n", ok ? "OK" : "FAILED");
+
+    return ok ? 0 : 1;
+}
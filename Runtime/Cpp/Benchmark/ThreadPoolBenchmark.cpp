@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  ThreadPoolBenchmark.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Compares the shared queue ThreadPool to the WorkStealingThreadPool on the task patterns of the
+// petri nets: tasks added from outside of the pool, sequential chains where each task adds its
+// successor, and fan-outs where each task adds several others.
+
+#include "../detail/ThreadPool.h"
+#include "../detail/WorkStealingThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+    using ClockType = std::chrono::steady_clock;
+
+    std::atomic_long remainingTasks;
+
+    void waitForTasks() {
+        while(remainingTasks > 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename Pool>
+    void chain(Pool &pool, long length) {
+        if(length > 0) {
+            pool.addTask(Petri::make_callable([&pool, length]() { chain(pool, length - 1); }));
+        }
+        --remainingTasks;
+    }
+
+    template <typename Pool>
+    void fanOut(Pool &pool, int depth) {
+        if(depth > 0) {
+            for(int i = 0; i < 2; ++i) {
+                pool.addTask(Petri::make_callable([&pool, depth]() { fanOut(pool, depth - 1); }));
+            }
+        }
+        --remainingTasks;
+    }
+
+    template <typename Pool>
+    double run(char const *pattern) {
+        Pool pool(std::max(2u, std::thread::hardware_concurrency()), "Benchmark");
+        auto const start = ClockType::now();
+        long tasks = 0;
+
+        if(std::string(pattern) == "external") {
+            tasks = remainingTasks = 200'000;
+            for(long i = 0; i < tasks; ++i) {
+                pool.addTask(Petri::make_callable([]() { --remainingTasks; }));
+            }
+        } else if(std::string(pattern) == "chain") {
+            tasks = remainingTasks = 200'001;
+            pool.addTask(Petri::make_callable([&pool]() { chain(pool, 200'000); }));
+        } else {
+            tasks = remainingTasks = (1 << 18) - 1;
+            pool.addTask(Petri::make_callable([&pool]() { fanOut(pool, 17); }));
+        }
+
+        waitForTasks();
+        auto const elapsed = std::chrono::duration<double, std::nano>(ClockType::now() - start).count();
+        pool.stop();
+
+        return elapsed / tasks;
+    }
+}
+
+int main() {
+    std::printf("%-10s %18s %18s\n", "pattern", "ThreadPool", "WorkStealing");
+    for(char const *pattern : {"external", "chain", "fanout"}) {
+        double shared = run<Petri::ThreadPool<void>>(pattern);
+        double stealing = run<Petri::WorkStealingThreadPool<void>>(pattern);
+        std::printf("%-10s %15.0fns %15.0fns\n", pattern, shared, stealing);
+    }
+
+    return 0;
+}
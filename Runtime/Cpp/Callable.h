@@ -1,6 +1,6 @@
 //
 //  Callable.h
-//  IA Pétri
+//  IA Pétri
 //
 //  Created by Rémi on 09/05/2015.
 //
@@ -8,35 +8,188 @@
 #ifndef Petri_Callable_h
 #define Petri_Callable_h
 
+#include <cstddef>
 #include <iostream>
 #include <memory>
+#include <new>
 #include <type_traits>
+#include <utility>
 
-template <typename ReturnType, typename... Args>
-struct CallableBase {
-    virtual ~CallableBase() = default;
-    virtual ReturnType operator()(Args...) = 0;
-    virtual std::unique_ptr<CallableBase<ReturnType, Args...>> copy_ptr() const = 0;
-};
+namespace Petri {
+
+    template <typename Signature>
+    class InlineCallable;
+
+    /**
+     * A copyable, type-erased callable, which does not use any virtual function. A plain function
+     * pointer or a lambda without any capture is called directly, and any other callable is called
+     * through a single function pointer instantiated for its type. The callables which fit in a
+     * small buffer, such as lambdas capturing a few values, are stored inside of the object instead
+     * of being allocated on the heap.
+     */
+    template <typename ReturnType, typename... Args>
+    class InlineCallable<ReturnType(Args...)> {
+        template <typename CallableType, typename = void>
+        struct IsCompatible : std::false_type {};
+
+        template <typename CallableType>
+        struct IsCompatible<CallableType, std::enable_if_t<std::is_void<ReturnType>::value || std::is_convertible<decltype(std::declval<CallableType &>()(std::declval<Args>()...)), ReturnType>::value>>
+                : std::integral_constant<bool, !std::is_same<CallableType, InlineCallable>::value> {};
+
+    public:
+        using FunctionPointer = ReturnType (*)(Args...);
+
+        // Enough for a lambda capturing a few values or references
+        static constexpr std::size_t BufferSize = 4 * sizeof(void *);
+
+        InlineCallable() noexcept = default;
+        InlineCallable(std::nullptr_t) noexcept {}
+
+        InlineCallable(FunctionPointer function) noexcept
+                : _function(function) {}
+
+        template <typename CallableType, typename = std::enable_if_t<IsCompatible<std::decay_t<CallableType>>::value>>
+        InlineCallable(CallableType &&callable) {
+            this->emplace<std::decay_t<CallableType>>(std::forward<CallableType>(callable));
+        }
+
+        InlineCallable(InlineCallable const &other)
+                : _function(other._function) {
+            if(other._manage) {
+                other._manage(Copy, &other._buffer, &_buffer);
+                _invoke = other._invoke;
+                _manage = other._manage;
+            }
+        }
+
+        InlineCallable(InlineCallable &&other) noexcept {
+            this->moveFrom(other);
+        }
+
+        InlineCallable &operator=(InlineCallable other) noexcept {
+            this->reset();
+            this->moveFrom(other);
+            return *this;
+        }
+
+        ~InlineCallable() {
+            this->reset();
+        }
 
+        /**
+         * Calls the wrapped callable, which must not be null.
+         */
+        ReturnType operator()(Args... args) const {
+            if(_function) {
+                return _function(std::forward<Args>(args)...);
+            }
+            return _invoke(&_buffer, std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const noexcept {
+            return _function != nullptr || _invoke != nullptr;
+        }
+
+        /**
+         * Returns the wrapped function pointer, if the callable is a plain function.
+         * @return The function pointer, or nullptr if the callable is anything else
+         */
+        FunctionPointer function() const noexcept {
+            return _function;
+        }
+
+    private:
+        enum Operation { Copy, Move, Destroy };
+        using Buffer = std::aligned_storage_t<BufferSize, alignof(std::max_align_t)>;
+        using Invoke = ReturnType (*)(Buffer *, Args...);
+        using Manage = void (*)(Operation, Buffer *, Buffer *);
+
+        template <typename CallableType>
+        using IsInline = std::integral_constant<bool,
+                                                sizeof(CallableType) <= BufferSize && alignof(CallableType) <= alignof(Buffer) &&
+                                                std::is_nothrow_move_constructible<CallableType>::value>;
+
+        template <typename CallableType>
+        using IsDirect = std::is_convertible<CallableType, FunctionPointer>;
+
+        template <typename CallableType, typename Value>
+        std::enable_if_t<IsDirect<CallableType>::value> emplace(Value &&function) {
+            _function = function;
+        }
+
+        template <typename CallableType, typename Value>
+        std::enable_if_t<!IsDirect<CallableType>::value && IsInline<CallableType>::value> emplace(Value &&callable) {
+            new(&_buffer) CallableType(std::forward<Value>(callable));
+            _invoke = [](Buffer *buffer, Args... args) -> ReturnType {
+                return (*reinterpret_cast<CallableType *>(buffer))(std::forward<Args>(args)...);
+            };
+            _manage = [](Operation operation, Buffer *from, Buffer *to) {
+                auto &callable = *reinterpret_cast<CallableType *>(from);
+                if(operation == Copy) {
+                    new(to) CallableType(callable);
+                } else if(operation == Move) {
+                    new(to) CallableType(std::move(callable));
+                    callable.~CallableType();
+                } else {
+                    callable.~CallableType();
+                }
+            };
+        }
+
+        template <typename CallableType, typename Value>
+        std::enable_if_t<!IsDirect<CallableType>::value && !IsInline<CallableType>::value> emplace(Value &&callable) {
+            *reinterpret_cast<CallableType **>(&_buffer) = new CallableType(std::forward<Value>(callable));
+            _invoke = [](Buffer *buffer, Args... args) -> ReturnType {
+                return (**reinterpret_cast<CallableType **>(buffer))(std::forward<Args>(args)...);
+            };
+            _manage = [](Operation operation, Buffer *from, Buffer *to) {
+                auto &callable = *reinterpret_cast<CallableType **>(from);
+                if(operation == Copy) {
+                    *reinterpret_cast<CallableType **>(to) = new CallableType(*callable);
+                } else if(operation == Move) {
+                    *reinterpret_cast<CallableType **>(to) = callable;
+                } else {
+                    delete callable;
+                }
+            };
+        }
+
+        void moveFrom(InlineCallable &other) noexcept {
+            _function = other._function;
+            if(other._manage) {
+                other._manage(Move, &other._buffer, &_buffer);
+                _invoke = other._invoke;
+                _manage = other._manage;
+            }
+            other._function = nullptr;
+            other._invoke = nullptr;
+            other._manage = nullptr;
+        }
+
+        void reset() noexcept {
+            if(_manage) {
+                _manage(Destroy, &_buffer, nullptr);
+            }
+            _function = nullptr;
+            _invoke = nullptr;
+            _manage = nullptr;
+        }
+
+        FunctionPointer _function = nullptr;
+        Invoke _invoke = nullptr;
+        Manage _manage = nullptr;
+        mutable Buffer _buffer;
+    };
+}
+
+// The type-erased callables of the previous versions, which were virtual classes. They are kept as
+// aliases of InlineCallable for the code naming them, but classes deriving from CallableBase must
+// now be wrapped in an InlineCallable instead.
+template <typename ReturnType, typename... Args>
+using CallableBase [[deprecated("Use Petri::InlineCallable<ReturnType(Args...)> instead")]] =
+Petri::InlineCallable<ReturnType(Args...)>;
 template <typename CallableType, typename ReturnType, typename... Args>
-struct Callable : public CallableBase<ReturnType, Args...> {
-    Callable(CallableType const &c)
-            : _c(c) {}
-    Callable(Callable const &c)
-            : _c(c._c) {}
-
-    virtual ReturnType operator()(Args... args) override {
-        return _c(args...);
-    }
-
-    virtual std::unique_ptr<CallableBase<ReturnType, Args...>> copy_ptr() const override {
-        return static_cast<std::unique_ptr<CallableBase<ReturnType, Args...>>>(
-        std::make_unique<Callable<CallableType, ReturnType, Args...>>(*this));
-    }
-
-private:
-    std::remove_reference_t<CallableType> _c;
-};
+using Callable [[deprecated("Use Petri::InlineCallable<ReturnType(Args...)> instead")]] =
+Petri::InlineCallable<ReturnType(Args...)>;
 
 #endif
@@ -31,7 +31,11 @@
 #define Petri_Common_h
 
 #include "../C/Types.h"
+#include "Arena.h"
+#include "SmallVector.h"
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <list>
 #include <string>
 
@@ -42,10 +46,118 @@ namespace Petri {
 
     using actionResult_t = Petri_actionResult_t;
 
+    /**
+     * How an entity accesses one of its variables while it is executed or evaluated.
+     */
+    enum class VariableAccess {
+        // The variable is locked for the whole execution, and can be freely read and modified.
+        Exclusive,
+        // The variable is only read, and is locked in shared mode so that several entities can read
+        // it concurrently.
+        Shared,
+        // The variable is only accessed through the lock-free operations of Atomic, and is not locked.
+        LockFree,
+    };
+
+    /**
+     * The base of the actions and transitions. Its variables are stored inline up to
+     * InlineVariables of them, and in the arena of its net beyond that, so that an entity takes
+     * 40 bytes on a 64 bit platform, whatever its number of variables up to InlineVariables.
+     */
     struct Entity {
     public:
-        Entity(uint64_t id)
-                : _id(id) {}
+        /**
+         * A variable of an entity, and how the entity accesses it.
+         */
+        struct Variable {
+            std::uint32_t id;
+            VariableAccess access;
+        };
+
+        static constexpr std::size_t InlineVariables = 2;
+        using VariableList = SmallVector<Variable, InlineVariables, ArenaAllocator<Variable>>;
+
+        /**
+         * A read-only view of one member of each variable of an entity, in the order they were
+         * added. It is invalidated when a variable is added to the entity.
+         */
+        template <typename Value, typename Member, Member Variable::*field>
+        class VariableView {
+        public:
+            class const_iterator {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = Value;
+                using difference_type = std::ptrdiff_t;
+                using pointer = Value const *;
+                using reference = Value;
+
+                explicit const_iterator(Variable const *variable)
+                        : _variable(variable) {}
+
+                Value operator*() const {
+                    return _variable->*field;
+                }
+
+                const_iterator &operator++() {
+                    ++_variable;
+                    return *this;
+                }
+
+                const_iterator operator++(int) {
+                    auto previous = *this;
+                    ++_variable;
+                    return previous;
+                }
+
+                bool operator==(const_iterator const &other) const {
+                    return _variable == other._variable;
+                }
+
+                bool operator!=(const_iterator const &other) const {
+                    return _variable != other._variable;
+                }
+
+            private:
+                Variable const *_variable;
+            };
+
+            explicit VariableView(VariableList const &variables)
+                    : _begin(variables.begin())
+                    , _end(variables.end()) {}
+
+            const_iterator begin() const {
+                return const_iterator(_begin);
+            }
+
+            const_iterator end() const {
+                return const_iterator(_end);
+            }
+
+            std::size_t size() const {
+                return _end - _begin;
+            }
+
+            bool empty() const {
+                return _begin == _end;
+            }
+
+        private:
+            Variable const *_begin;
+            Variable const *_end;
+        };
+
+        using VariableIds = VariableView<std::uint_fast32_t, std::uint32_t, &Variable::id>;
+        using VariableAccesses = VariableView<VariableAccess, VariableAccess, &Variable::access>;
+
+        /**
+         * Creates an entity, whose variables are allocated in the specified arena.
+         * @param id The ID of the entity.
+         * @param arena The arena of the net of the entity, or nullptr to use the heap.
+         */
+        Entity(uint64_t id, Arena *arena = nullptr)
+                : _id(id)
+                , _vars(ArenaAllocator<Variable>(arena)) {}
 
         auto ID() const {
             return _id;
@@ -58,22 +170,49 @@ namespace Petri {
         /**
          * Adds a variable to the entity's associated ones.
          * @param id The new variable to add.
+         * @param access How the entity accesses the variable, which tells whether it is to be locked.
          */
-        void addVariable(std::uint_fast32_t id) {
-            _vars.push_back(id);
+        void addVariable(std::uint_fast32_t id, VariableAccess access = VariableAccess::Exclusive) {
+            _vars.push_back({static_cast<std::uint32_t>(id), access});
         }
 
         /**
          * Returns a list of the associated Atomic variables' IDs.
          * @return The list of variabels of the entity.
          */
-        std::list<uint_fast32_t> const &getVariables() const {
+        VariableIds getVariables() const {
+            return VariableIds(_vars);
+        }
+
+        /**
+         * Returns how the entity accesses its variables, in the same order as getVariables().
+         * @return The access of each variable of the entity.
+         */
+        VariableAccesses getVariablesAccess() const {
+            return VariableAccesses(_vars);
+        }
+
+        /**
+         * Returns the associated Atomic variables' IDs along with how the entity accesses each of
+         * them, in the same order as getVariables().
+         * @return The variables of the entity and their access.
+         */
+        VariableList const &getVariablesWithAccess() const {
             return _vars;
         }
 
+    protected:
+        /**
+         * Moves the variables of the entity into the arena of its net.
+         * @param arena The arena of the net
+         */
+        void moveVariablesTo(Arena &arena) {
+            _vars = VariableList(_vars.begin(), _vars.end(), ArenaAllocator<Variable>(&arena));
+        }
+
     private:
         std::uint64_t _id;
-        std::list<std::uint_fast32_t> _vars;
+        VariableList _vars;
     };
 }
 
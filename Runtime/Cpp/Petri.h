@@ -34,6 +34,8 @@
 #include "DebugServer.h"
 #include "PetriDebug.h"
 #include "PetriNet.h"
+#include "PetriNetPrototype.h"
 #include "PetriUtils.h"
+#include "StaticPetriNet.h"
 
 #endif
@@ -36,7 +36,7 @@ namespace Petri {
 
     class DebugServer;
     template <typename _ReturnType>
-    class ThreadPool;
+    class WorkStealingThreadPool;
 
     class PetriDebug : public PetriNet {
     public:
@@ -62,7 +62,7 @@ namespace Petri {
          * Retrieves the underlying ThreadPool object.
          * @return The underlying ThreadPool
          */
-        ThreadPool<void> &actionsPool();
+        WorkStealingThreadPool<void> &actionsPool();
 
         /**
          * Finds the state associated to the specified ID, or nullptr if not found.
@@ -32,6 +32,7 @@
 
 #include "DynamicLib.h"
 #include "PetriDebug.h"
+#include "PetriNetPrototype.h"
 #include "PetriUtils.h"
 #include <memory>
 
@@ -67,6 +68,21 @@ namespace Petri {
          */
         std::unique_ptr<PetriDebug> createDebug();
 
+        /**
+         * Gets the prototype of the PetriNet contained in the dynamic library, which is created on
+         * the first call and then shared by all of the instances created from the library.
+         * @return The prototype of the PetriNet
+         */
+        std::shared_ptr<PetriNetPrototype> prototype();
+
+        /**
+         * Creates a lightweight instance of the PetriNet contained in the dynamic library, which
+         * shares its actions, transitions and worker threads with the other instances. It must be
+         * destroyed before the library is unloaded.
+         * @return The PetriNet object wrapped in a std::unique_ptr
+         */
+        std::unique_ptr<PetriNet> createInstance();
+
         /**
          * Returns the SHA1 hash of the dynamic library. It uniquely identifies the code of the
          * PetriNet,
@@ -114,6 +130,14 @@ namespace Petri {
             _hashPtr = this->loadSymbol<char const *()>((prefix + "_getHash").c_str());
         }
 
+        /**
+         * Unloads the dynamic library, along with the prototype created from it.
+         */
+        virtual void unload() override {
+            _prototype.reset();
+            this->DynamicLib::unload();
+        }
+
         /**
          * Gives access to the path of the dynamic library archive, relative to the executable path.
          * @return The relative path of the dylib
@@ -128,6 +152,7 @@ namespace Petri {
         void *(*_createPtr)() = nullptr;
         void *(*_createDebugPtr)() = nullptr;
         char const *(*_hashPtr)() = nullptr;
+        std::shared_ptr<PetriNetPrototype> _prototype;
 
         bool _c_dynamicLib;
     };
@@ -30,6 +30,8 @@
 #ifndef Petri_PetriNet_h
 #define Petri_PetriNet_h
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -37,6 +39,7 @@ namespace Petri {
 
     class Atomic;
     class Action;
+    struct StaticNet;
 
     class PetriNet {
     public:
@@ -50,12 +53,21 @@ namespace Petri {
         virtual ~PetriNet();
 
         /**
-         * Adds an Action to the PetriNet. The net must not be running yet.
+         * Adds an Action to the PetriNet. The net must not be running nor frozen yet.
          * @param action The action to add
          * @param active Controls whether the action is active as soon as the net is started or not
          */
         virtual Action &addAction(Action action, bool active = false);
 
+        /**
+         * Adds the variables, actions and transitions described by the tables of a static net in a
+         * single pass, as the generated code does instead of adding them one by one. The actions
+         * are added with addAction(), and can then be modified like any other. The net must not be
+         * running nor frozen yet.
+         * @param net The tables describing the net, see StaticNet
+         */
+        void build(StaticNet const &net);
+
         /**
          * Checks whether the net is running.
          * @return true means that the net has been started, and we can not add any more action to
@@ -63,25 +75,73 @@ namespace Petri {
          */
         bool running() const;
 
+        /**
+         * Compiles the actions and transitions of the net into the compact form it is executed on.
+         * This is done by run() if it has not been done before, and is a no-op if the net is
+         * already frozen. Once frozen, no action can be added to the net anymore, and the actions,
+         * their transitions and the variables they depend on must not be modified.
+         */
+        void freeze();
+
+        /**
+         * Gets the maximum number of successive states a worker thread executes on its own, see
+         * setChainDepth().
+         * @return The maximum length of a chain of states executed without the thread pool.
+         */
+        std::size_t chainDepth() const;
+
+        /**
+         * Changes the maximum number of successive states a worker thread executes on its own. When
+         * a transition of a state enables the next one, the worker goes on with the next state
+         * directly instead of adding it to the thread pool, which is faster and keeps its data in
+         * the cache. Once the chain reaches this length, the next state goes through the thread
+         * pool, so that the other states get their turn. 0 disables the chaining.
+         * @param depth The maximum length of a chain of states executed without the thread pool.
+         */
+        void setChainDepth(std::size_t depth);
+
         /**
          * Starts the Petri net. It must not be already running. If no states are initially active,
          * this is a no-op.
+         * The actions are executed by a fixed number of worker threads, all spawned here: as many as
+         * the states the net can run in parallel according to its graph, up to about one per core.
+         * A state waiting for its transitions does not occupy any of them, but an action blocking
+         * its thread delays the other actions of the net.
          */
         virtual void run();
 
         /**
          * Stops the Petri net. It blocks the calling thread until all running states are finished,
          * but do not allows new states to be enabled. If the net is not running, this is a no-op.
+         * The worker threads are kept, so that the net can be run again, see reset().
          */
         virtual void stop();
 
+        /**
+         * Restores the initial state of a net which is not running, so that it can be run again
+         * with the same actions, transitions and worker threads: the tokens of the actions are
+         * cleared, and the variables get back the values they had when the net was frozen.
+         */
+        void reset();
+
         /**
          * Blocks the calling thread until the Petri net has completed its whole execution.
          */
         virtual void join();
 
         /**
-         * Adds an Atomic variable designated by the specified id.
+         * Blocks the calling thread until the Petri net has completed its whole execution, or until
+         * the timeout expires.
+         * @param timeout The maximum duration to wait for
+         * @return true if the execution is over, false if the timeout has expired
+         */
+        bool joinFor(std::chrono::nanoseconds timeout);
+
+        /**
+         * Adds an Atomic variable designated by the specified id. The variables are stored in a
+         * table indexed by their id, which should thus be small and dense, as are the values of the
+         * enum generated for the variables of a petri net document. The ids from 65536 on are
+         * looked up in a slower sparse map instead.
          * @param id the id of the new Atomic variable
          */
         void addVariable(std::uint_fast32_t id);
@@ -98,7 +158,17 @@ namespace Petri {
     protected:
         struct Internals;
         PetriNet(std::unique_ptr<Internals> internals);
+
+        // Creates a frozen net from the tables of a static net, see StaticPetriNet
+        PetriNet(std::string const &name, StaticNet const &net);
+
         std::unique_ptr<Internals> _internals;
+
+    private:
+        friend class PetriNetPrototype;
+
+        // Creates an instance of a frozen net, see PetriNetPrototype
+        PetriNet(std::shared_ptr<PetriNet> prototype);
     };
 }
 
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+//
+//  PetriNetPrototype.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#ifndef Petri_PetriNetPrototype_h
+#define Petri_PetriNetPrototype_h
+
+#include "PetriNet.h"
+#include <memory>
+#include <string>
+
+namespace Petri {
+
+    /**
+     * The shared form of a petri net, from which any number of instances are created. The actions,
+     * the transitions, their callables and their names are only stored once, in the prototype,
+     * which the instances share along with the worker threads executing them: an instance only
+     * owns its marking, its variables and the records of its active states.
+     */
+    class PetriNetPrototype {
+    public:
+        /**
+         * Creates the prototype of a petri net, which is frozen and not run by itself anymore.
+         * @param net The net whose actions and transitions are shared by the instances. It must not
+         * be running.
+         */
+        explicit PetriNetPrototype(std::unique_ptr<PetriNet> net);
+        ~PetriNetPrototype();
+
+        PetriNetPrototype(PetriNetPrototype const &) = delete;
+        PetriNetPrototype &operator=(PetriNetPrototype const &) = delete;
+
+        /**
+         * Creates an instance of the net, which can be run, stopped and reset independently from
+         * the other instances. Its variables start with the values those of the net had when it was
+         * frozen. It keeps the actions and the transitions of the prototype alive, and can thus
+         * outlive it.
+         * @return The new instance, whose actions can not be modified
+         */
+        std::unique_ptr<PetriNet> createInstance() const;
+
+        /**
+         * Returns the name of the net, shared by its instances.
+         * @return The name of the net
+         */
+        std::string const &name() const;
+
+    private:
+        std::shared_ptr<PetriNet> _net;
+    };
+}
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  SmallVector.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#ifndef Petri_SmallVector_h
+#define Petri_SmallVector_h
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace Petri {
+
+    /**
+     * A vector of trivially copyable values, whose first N values are stored inside of the object
+     * itself. It only allocates memory, from its allocator, once it grows beyond them. The heap
+     * pointer shares the storage of the inline values, so that the vector only takes the size of
+     * its N values, two 32 bit counts and its allocator.
+     */
+    template <typename T, std::size_t N, typename Allocator = std::allocator<T>>
+    class SmallVector : private Allocator {
+        static_assert(std::is_trivially_copyable<T>::value, "The values of a SmallVector must be trivially copyable!");
+        static_assert(N > 0, "A SmallVector must have some inline storage!");
+
+        using Traits = std::allocator_traits<Allocator>;
+
+    public:
+        using value_type = T;
+        using const_iterator = T const *;
+        using iterator = T *;
+
+        explicit SmallVector(Allocator const &allocator = Allocator()) noexcept
+                : Allocator(allocator) {}
+
+        template <typename Iterator>
+        SmallVector(Iterator first, Iterator last, Allocator const &allocator = Allocator())
+                : Allocator(allocator) {
+            for(; first != last; ++first) {
+                this->push_back(*first);
+            }
+        }
+
+        SmallVector(SmallVector const &other)
+                : SmallVector(other.begin(), other.end(), Traits::select_on_container_copy_construction(other.allocator())) {}
+
+        SmallVector(SmallVector &&other) noexcept
+                : Allocator(std::move(other.allocator())) {
+            this->steal(other);
+        }
+
+        SmallVector &operator=(SmallVector const &other) {
+            if(this != &other) {
+                this->clear();
+                for(auto const &value : other) {
+                    this->push_back(value);
+                }
+            }
+            return *this;
+        }
+
+        SmallVector &operator=(SmallVector &&other) noexcept {
+            static_assert(Traits::propagate_on_container_move_assignment::value,
+                          "The allocator of a SmallVector must be moved along with its values!");
+            if(this != &other) {
+                this->deallocate();
+                this->allocator() = std::move(other.allocator());
+                this->steal(other);
+            }
+            return *this;
+        }
+
+        ~SmallVector() {
+            this->deallocate();
+        }
+
+        void push_back(T const &value) {
+            if(_size == _capacity) {
+                this->grow();
+            }
+            this->data()[_size++] = value;
+        }
+
+        void clear() noexcept {
+            _size = 0;
+        }
+
+        T *data() noexcept {
+            return _capacity > N ? _storage.heap : reinterpret_cast<T *>(&_storage.values);
+        }
+        T const *data() const noexcept {
+            return _capacity > N ? _storage.heap : reinterpret_cast<T const *>(&_storage.values);
+        }
+
+        T &operator[](std::size_t i) noexcept {
+            return this->data()[i];
+        }
+        T const &operator[](std::size_t i) const noexcept {
+            return this->data()[i];
+        }
+
+        iterator begin() noexcept {
+            return this->data();
+        }
+        iterator end() noexcept {
+            return this->data() + _size;
+        }
+        const_iterator begin() const noexcept {
+            return this->data();
+        }
+        const_iterator end() const noexcept {
+            return this->data() + _size;
+        }
+
+        std::size_t size() const noexcept {
+            return _size;
+        }
+        bool empty() const noexcept {
+            return _size == 0;
+        }
+        std::size_t capacity() const noexcept {
+            return _capacity;
+        }
+
+        Allocator const &allocator() const noexcept {
+            return *this;
+        }
+
+    private:
+        Allocator &allocator() noexcept {
+            return *this;
+        }
+
+        void grow() {
+            auto const capacity = _capacity * 2;
+            T *values = Traits::allocate(this->allocator(), capacity);
+            std::copy(this->begin(), this->end(), values);
+            this->deallocate();
+            _storage.heap = values;
+            _capacity = static_cast<std::uint32_t>(capacity);
+        }
+
+        void deallocate() noexcept {
+            if(_capacity > N) {
+                Traits::deallocate(this->allocator(), _storage.heap, _capacity);
+            }
+            _capacity = N;
+        }
+
+        // Takes the values of another vector, whose allocator has been taken as well
+        void steal(SmallVector &other) noexcept {
+            if(other._capacity > N) {
+                _storage.heap = other._storage.heap;
+            } else {
+                std::copy(other.begin(), other.end(), reinterpret_cast<T *>(&_storage.values));
+            }
+            _size = other._size;
+            _capacity = other._capacity;
+            other._size = 0;
+            other._capacity = N;
+        }
+
+        union Storage {
+            std::aligned_storage_t<sizeof(T) * N, alignof(T)> values;
+            T *heap;
+        } _storage;
+        std::uint32_t _size = 0;
+        std::uint32_t _capacity = N;
+    };
+}
+
+#endif
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  StaticPetriNet.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#ifndef Petri_StaticPetriNet_h
+#define Petri_StaticPetriNet_h
+
+#include "Common.h"
+#include "PetriNet.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace Petri {
+
+    /**
+     * A variable of an action or a transition of a StaticNet.
+     */
+    struct StaticVariable {
+        std::uint_fast32_t id;
+        VariableAccess access;
+    };
+
+    /**
+     * An action of a StaticNet. The transitions of the actions are grouped by action, in the order
+     * they are evaluated: those of an action are the range [transitionsBegin, transitionsEnd) of
+     * the transitions table, which starts where the range of the previous action ends. Its
+     * variables are the range [variablesBegin, variablesEnd) of the variables table.
+     */
+    struct StaticAction {
+        std::uint64_t id;
+        char const *name;
+        actionResult_t (*function)(PetriNet &);
+        std::size_t requiredTokens;
+        bool active;
+        std::uint32_t transitionsBegin;
+        std::uint32_t transitionsEnd;
+        std::uint32_t variablesBegin;
+        std::uint32_t variablesEnd;
+    };
+
+    /**
+     * A transition of a StaticNet, leading to the action of index target. Its variables are the
+     * range [variablesBegin, variablesEnd) of the variables table.
+     */
+    struct StaticTransition {
+        std::uint64_t id;
+        char const *name;
+        std::uint32_t target;
+        bool (*condition)(PetriNet &, actionResult_t);
+        bool pure;
+        bool hasExpectedResult;
+        actionResult_t expectedResult;
+        std::uint32_t variablesBegin;
+        std::uint32_t variablesEnd;
+        std::chrono::nanoseconds delayBetweenEvaluation = std::chrono::milliseconds(10);
+    };
+
+    /**
+     * The topology of a petri net as constant tables, as generated for a petri net document.
+     * PetriNet::build() adds the actions and transitions they describe in a single pass. The tables
+     * of a StaticPetriNet are checked at compile time, and lowered straight into the form the net is
+     * executed on: no Action nor Transition is ever created for them.
+     */
+    struct StaticNet {
+        StaticAction const *actions;
+        std::uint32_t actionsCount;
+        StaticTransition const *transitions;
+        std::uint32_t transitionsCount;
+        StaticVariable const *variables;
+        std::uint32_t variablesCount;
+        // The ids of the variables of the net, which all start at 0
+        std::uint_fast32_t const *netVariables;
+        std::uint32_t netVariablesCount;
+
+        /**
+         * The function of the actions which do nothing, such as the entry and exit points of an
+         * inner petri net.
+         */
+        static actionResult_t emptyAction(PetriNet &) {
+            return {};
+        }
+
+        /**
+         * The condition of the transitions which are always fulfilled.
+         */
+        static bool alwaysFulfilled(PetriNet &, actionResult_t) {
+            return true;
+        }
+
+        /**
+         * Checks that the transitions of the actions form contiguous ranges covering the whole
+         * transitions table, and that they all lead to an existing action.
+         */
+        constexpr bool transitionsAreValid() const {
+            std::uint32_t end = 0;
+            for(std::uint32_t a = 0; a < actionsCount; ++a) {
+                if(actions[a].transitionsBegin != end || actions[a].transitionsEnd < end) {
+                    return false;
+                }
+                end = actions[a].transitionsEnd;
+            }
+            for(std::uint32_t t = 0; t < transitionsCount; ++t) {
+                if(transitions[t].target >= actionsCount) {
+                    return false;
+                }
+            }
+            return end == transitionsCount;
+        }
+
+        /**
+         * Checks that the actions and transitions only use variables of the net, through ranges of
+         * the variables table.
+         */
+        constexpr bool variablesAreValid() const {
+            for(std::uint32_t a = 0; a < actionsCount; ++a) {
+                if(!this->isVariablesRange(actions[a].variablesBegin, actions[a].variablesEnd)) {
+                    return false;
+                }
+            }
+            for(std::uint32_t t = 0; t < transitionsCount; ++t) {
+                if(!this->isVariablesRange(transitions[t].variablesBegin, transitions[t].variablesEnd)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Checks that each action and transition has a function to be called.
+         */
+        constexpr bool functionsAreValid() const {
+            for(std::uint32_t a = 0; a < actionsCount; ++a) {
+                if(actions[a].function == nullptr) {
+                    return false;
+                }
+            }
+            for(std::uint32_t t = 0; t < transitionsCount; ++t) {
+                if(transitions[t].condition == nullptr) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        constexpr bool isVariablesRange(std::uint32_t begin, std::uint32_t end) const {
+            if(begin > end || end > variablesCount) {
+                return false;
+            }
+            for(auto v = begin; v < end; ++v) {
+                bool found = false;
+                for(std::uint32_t n = 0; n < netVariablesCount; ++n) {
+                    found = found || netVariables[n] == variables[v].id;
+                }
+                if(!found) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /**
+     * A petri net whose topology is known at compile time, as the constant tables of a StaticNet.
+     * The tables are checked at compile time, and the net is built without creating any Action nor
+     * Transition. It is already frozen, and is otherwise executed as any other net: its actions and
+     * conditions are called through the function pointers of the tables. It is run, stopped, reset
+     * and shared by a PetriNetPrototype like any other net, but can not be modified.
+     */
+    template <StaticNet const &Net>
+    class StaticPetriNet : public PetriNet {
+        static_assert(Net.transitionsAreValid(),
+                      "The transitions of a static petri net must be grouped by action and lead to existing actions!");
+        static_assert(Net.variablesAreValid(), "A static petri net uses a variable it does not declare!");
+        static_assert(Net.functionsAreValid(), "A static petri net has an action or a transition without function!");
+
+    public:
+        /**
+         * Creates the petri net described by the tables of Net.
+         * @param name The name of the petri net, see PetriNet::PetriNet()
+         */
+        StaticPetriNet(std::string const &name = "")
+                : PetriNet(name, Net) {}
+    };
+}
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  AllocationTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks that the execution cycles of a petri net do not allocate any memory, as the records of its
+// states and the observers of its variables are sized when it is frozen. The global operator new is
+// replaced so as to count the allocations of the whole process, and the net goes through forks,
+// joins, pure transitions woken up by a variable change and polled transitions scheduled in the
+// timer wheel. Only the first cycles are left out, as they start the timer thread.
+
+#include "../Action.h"
+#include "../Atomic.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include "TestUtils.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+    using namespace Petri;
+    using ClockType = std::chrono::steady_clock;
+
+    enum : std::int64_t { WarmUpCycles = 10, Cycles = 1010 };
+    enum { Cycle = 0, Handshake = 1 };
+
+    long allocationsAtWarmUp, allocationsAtEnd;
+    ClockType::time_point handshakeDate;
+}
+
+int main() {
+    PetriNet petriNet("AllocationTest");
+    petriNet.addVariable(Cycle);
+    petriNet.addVariable(Handshake);
+
+    Action &begin = petriNet.addAction(Action(1, "Begin", make_param_action_callable([](PetriNet &pn) {
+                                                  auto cycle = ++pn.getVariable(Cycle).value();
+                                                  if(cycle == WarmUpCycles) {
+                                                      allocationsAtWarmUp = allocations;
+                                                  } else if(cycle == Cycles) {
+                                                      allocationsAtEnd = allocations;
+                                                  }
+                                                  return actionResult_t(0);
+                                              }),
+                                              1),
+                                       true);
+    begin.addVariable(Cycle);
+
+    Action &handshake = petriNet.addAction(Action(2, "Handshake", make_param_action_callable([](PetriNet &pn) {
+                                                      pn.getVariable(Handshake).value() =
+                                                      pn.getVariable(Cycle).value();
+                                                      handshakeDate = ClockType::now();
+                                                      return actionResult_t(0);
+                                                  }),
+                                                  1));
+    handshake.addVariable(Cycle);
+    handshake.addVariable(Handshake);
+
+    Action &wait = petriNet.addAction(Action(3, "Wait", make_action_callable([]() { return actionResult_t(0); }), 1));
+    Action &join = petriNet.addAction(Action(4, "Join", make_action_callable([]() { return actionResult_t(0); }), 2));
+    Action &end = petriNet.addAction(Action(5, "End", make_action_callable([]() { return actionResult_t(0); }), 1));
+
+    auto always = make_transition_callable([](actionResult_t) { return true; });
+    begin.addTransition(10, "", handshake, always).setPure(true);
+    begin.addTransition(11, "", wait, always).setPure(true);
+
+    // Woken up by the change of the Handshake variable
+    Transition &handshakeDone =
+    wait.addTransition(12, "", join, make_param_transition_callable([](PetriNet &pn, actionResult_t) {
+                           return pn.getVariable(Handshake).value() == pn.getVariable(Cycle).value();
+                       }));
+    handshakeDone.addVariable(Cycle);
+    handshakeDone.addVariable(Handshake);
+    handshakeDone.setPure(true);
+
+    // Polled through the timer wheel
+    Transition &delay = handshake.addTransition(13, "", join, make_transition_callable([](actionResult_t) {
+                                                    return ClockType::now() - handshakeDate >= std::chrono::microseconds(300);
+                                                }));
+    delay.setDelayBetweenEvaluation(std::chrono::microseconds(100));
+
+    Transition &loop = join.addTransition(14, "", begin, make_param_transition_callable([](PetriNet &pn, actionResult_t) {
+                                              return pn.getVariable(Cycle).value() < Cycles;
+                                          }));
+    loop.addVariable(Cycle);
+    loop.setPure(true);
+    Transition &exit = join.addTransition(15, "", end, make_param_transition_callable([](PetriNet &pn, actionResult_t) {
+                                              return pn.getVariable(Cycle).value() >= Cycles;
+                                          }));
+    exit.addVariable(Cycle);
+    exit.setPure(true);
+
+    petriNet.run();
+    petriNet.join();
+
+    long count = allocationsAtEnd - allocationsAtWarmUp;
+    std::printf("%ld allocations in %ld execution cycles\n", count, long(Cycles - WarmUpCycles));
+    if(petriNet.getVariable(Cycle).value() != Cycles || count != 0) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  CallableTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks the semantics of InlineCallable: plain functions and captureless lambdas are called
+// directly, small callables are stored inline without any allocation, and large ones are copied,
+// moved and destroyed correctly from the heap.
+
+#include "../Callable.h"
+#include "TestUtils.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace {
+    using namespace Petri;
+
+    int increment(int x) {
+        return x + 1;
+    }
+
+    struct Large {
+        long values[8];
+        int operator()(int x) const {
+            return x + int(values[0]);
+        }
+    };
+}
+
+int main() {
+    using Callable = InlineCallable<int(int)>;
+
+    Callable function(&increment);
+    check(function(1) == 2 && function.function() == &increment, "function pointer");
+
+    Callable captureless([](int x) { return x * 2; });
+    check(captureless(3) == 6 && captureless.function() != nullptr, "captureless lambda");
+
+    long before = allocations;
+    Callable small([k = 5](int x) { return x + k; });
+    Callable smallCopy = small;
+    check(allocations == before, "small callables must not allocate");
+    check(small(1) == 6 && smallCopy(0) == 5 && small.function() == nullptr, "small callable");
+
+    Callable large(Large{{7}});
+    Callable largeCopy = large;
+    check(large(1) == 8 && largeCopy(0) == 7, "large callable");
+
+    auto shared = std::make_shared<int>(3);
+    {
+        Callable owner([shared](int x) { return x + *shared; });
+        Callable moved = std::move(owner);
+        check(!owner && moved(0) == 3 && shared.use_count() == 2, "moved callable");
+        moved = largeCopy;
+        check(moved(1) == 8 && shared.use_count() == 1, "assigned callable");
+        moved = nullptr;
+        check(!moved, "reset callable");
+    }
+
+    std::string text = "abc";
+    InlineCallable<void()> append([&text]() { text += "d"; });
+    append();
+    check(text == "abcd", "void callable");
+
+    InlineCallable<long(int)> converted(&increment);
+    check(converted(1) == 2, "converted return type");
+
+    if(failures) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
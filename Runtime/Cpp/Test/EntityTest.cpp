@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  EntityTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks the compact representation of the entities: their first variables are stored inline
+// without any allocation and the following ones keep their order, also seen by the accessors of
+// their ids and accesses alone, the names are interned so that entities with the same name share
+// it and are removed along with the last of them, and the variables survive the move of an action
+// into its net.
+
+#include "../Action.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include "../detail/NameTable.h"
+#include "TestUtils.h"
+#include <cstdio>
+
+namespace {
+    using namespace Petri;
+
+    actionResult_t nothing() {
+        return 0;
+    }
+
+    // Checks the variables along with their access, and the views of their ids and accesses alone
+    bool hasVariables(Entity const &entity, std::uint32_t count) {
+        auto const &variables = entity.getVariablesWithAccess();
+        auto const ids = entity.getVariables();
+        auto const accesses = entity.getVariablesAccess();
+        if(variables.size() != count || ids.size() != count || accesses.size() != count) {
+            return false;
+        }
+        auto id = ids.begin();
+        auto access = accesses.begin();
+        for(std::uint32_t i = 0; i < count; ++i, ++id, ++access) {
+            auto const expected = i % 2 ? VariableAccess::Shared : VariableAccess::Exclusive;
+            if(variables[i].id != i || variables[i].access != expected || *id != i || *access != expected) {
+                return false;
+            }
+        }
+        return id == ids.end() && access == accesses.end();
+    }
+
+    void addVariables(Entity &entity, std::uint32_t count) {
+        for(std::uint32_t i = 0; i < count; ++i) {
+            entity.addVariable(i, i % 2 ? VariableAccess::Shared : VariableAccess::Exclusive);
+        }
+    }
+}
+
+int main() {
+    auto const names = NameTable::instance().size();
+    Action standalone(1, "Standalone", &nothing, 1);
+    auto before = allocations.load();
+    addVariables(standalone, Entity::InlineVariables);
+    check(allocations == before, "inline variables must not allocate");
+    check(hasVariables(standalone, Entity::InlineVariables), "inline variables");
+
+    standalone.addVariable(Entity::InlineVariables, VariableAccess::Exclusive);
+    standalone.addVariable(Entity::InlineVariables + 1, VariableAccess::Shared);
+    check(hasVariables(standalone, Entity::InlineVariables + 2), "spilled variables");
+
+    Entity copy = standalone;
+    check(hasVariables(copy, Entity::InlineVariables + 2), "copied variables");
+
+    PetriNet petriNet("EntityTest");
+    Action &first = petriNet.addAction(std::move(standalone), true);
+    check(hasVariables(first, Entity::InlineVariables + 2), "variables of an action added to a net");
+
+    Action &second = petriNet.addAction(Action(2, "Second", &nothing, 1));
+    before = allocations.load();
+    addVariables(second, 16);
+    check(allocations == before, "the spilled variables of an action of a net must be in its arena");
+    check(hasVariables(second, 16), "variables in the arena");
+
+    Action &third = petriNet.addAction(Action(3, "Second", &nothing, 1));
+    check(&second.name() == &third.name() && third.name() == "Second", "interned action names");
+    third.setName("Third");
+    check(third.name() == "Third" && second.name() == "Second", "renamed action");
+
+    auto always = make_transition_callable([](actionResult_t) { return true; });
+    auto &t1 = first.addTransition(4, "Transition", second, always);
+    auto &t2 = second.addTransition(5, "Transition", third, always);
+    check(&t1.name() == &t2.name() && t1.name() == "Transition", "interned transition names");
+    addVariables(t1, 3);
+    check(hasVariables(t1, 3), "transition variables");
+
+    {
+        PetriNet other("Other");
+        Action &a = other.addAction(Action(1, "Second", &nothing, 1));
+        Action &b = other.addAction(Action(2, "OtherOnly", &nothing, 1));
+        a.addTransition(3, "OtherTransition", b, always);
+        check(&a.name() == &second.name(), "names shared by different nets");
+        check(NameTable::instance().size() == names + 6, "names of two nets");
+    }
+    check(NameTable::instance().size() == names + 4, "names removed along with the last entity using them");
+    third.setName("Second");
+    check(NameTable::instance().size() == names + 3, "name removed when renaming the last entity using it");
+
+    if(failures) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  ForkTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks that the branches of a fork run concurrently: an action enables two branches which each
+// block their worker for a while before a join, and the whole net must take about the duration of
+// one branch, and not of both of them one after the other.
+
+#include "../Action.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+    using namespace Petri;
+    using ClockType = std::chrono::steady_clock;
+
+    constexpr auto BranchDuration = std::chrono::milliseconds(200);
+
+    actionResult_t branch() {
+        std::this_thread::sleep_for(BranchDuration);
+        return 0;
+    }
+
+    actionResult_t nothing() {
+        return 0;
+    }
+}
+
+int main() {
+    PetriNet petriNet("ForkTest");
+    Action &fork = petriNet.addAction(Action(1, "Fork", &nothing, 1), true);
+    Action &left = petriNet.addAction(Action(2, "Left", &branch, 1));
+    Action &right = petriNet.addAction(Action(3, "Right", &branch, 1));
+    Action &join = petriNet.addAction(Action(4, "Join", &nothing, 2));
+    Action &end = petriNet.addAction(Action(5, "End", &nothing, 1));
+
+    auto always = make_transition_callable([](actionResult_t) { return true; });
+    fork.addTransition(6, "", left, always).setPure(true);
+    fork.addTransition(7, "", right, always).setPure(true);
+    left.addTransition(8, "", join, always).setPure(true);
+    right.addTransition(9, "", join, always).setPure(true);
+    join.addTransition(10, "", end, always).setPure(true);
+    petriNet.freeze();
+
+    auto const start = ClockType::now();
+    petriNet.run();
+    petriNet.join();
+    auto const duration = ClockType::now() - start;
+    std::printf("Fork of 2 branches of %lldms run in %.0fms\n", static_cast<long long>(BranchDuration.count()),
+                std::chrono::duration<double, std::milli>(duration).count());
+
+    if(duration >= BranchDuration * 3 / 2) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
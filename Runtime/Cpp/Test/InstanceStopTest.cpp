@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+//
+//  InstanceStopTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks that an instance of a prototype stopped or destroyed from an action of another instance,
+// which shares its worker threads, is drained before stop() returns: the stopped instance is
+// blocked in an action when the other one stops it, and must have left it by then.
+
+#include "../Action.h"
+#include "../PetriNetPrototype.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+namespace {
+    using namespace Petri;
+
+    std::unique_ptr<PetriNet> sleeper;
+    std::atomic_bool started = {false};
+    std::atomic_bool slept = {false};
+    std::atomic_bool destroy = {false};
+    std::atomic_int failures = {0};
+
+    // The sleeper blocks its worker for a while, and the other instance stops it meanwhile
+    actionResult_t work(PetriNet &pn) {
+        if(&pn == sleeper.get()) {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            slept = true;
+        } else {
+            while(!started) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            if(destroy) {
+                sleeper.reset();
+            } else {
+                sleeper->stop();
+            }
+            failures += !slept;
+        }
+        return 0;
+    }
+
+    void stopFromInstance(PetriNetPrototype const &prototype, bool destroySleeper) {
+        started = false;
+        slept = false;
+        destroy = destroySleeper;
+
+        sleeper = prototype.createInstance();
+        auto stopper = prototype.createInstance();
+        sleeper->run();
+        stopper->run();
+        stopper->join();
+    }
+}
+
+int main() {
+    auto net = std::make_unique<PetriNet>("InstanceStopTest");
+    net->addAction(Action(1, "Work", &work, 1), true);
+    PetriNetPrototype prototype(std::move(net));
+
+    stopFromInstance(prototype, false);
+    stopFromInstance(prototype, true);
+    sleeper.reset();
+
+    std::printf("%d failures\n", failures.load());
+    if(failures != 0) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
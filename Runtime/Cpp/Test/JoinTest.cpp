@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  JoinTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Measures the latency of PetriNet::join(), which is woken up as soon as the execution ends: many
+// short nets are run back to back, and the average duration of a run must stay well below the
+// polling period join() used to have. Also checks that joinFor() gives up once its timeout has
+// expired while the net is still running, and that ThreadPool::join() returns once its tasks are
+// done, or once the pool is stopped by another thread while a task is still pending.
+
+#include "../Action.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include "../detail/ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+    using namespace Petri;
+    using ClockType = std::chrono::steady_clock;
+
+    enum { Runs = 200, Tasks = 100 };
+
+    // Returns the number of tasks executed before join() returned
+    int joinPool() {
+        std::atomic_int executed = {0};
+        ThreadPool<void> pool(2, "JoinTest");
+        for(int i = 0; i < Tasks; ++i) {
+            pool.addTask(make_callable([&executed]() { ++executed; }));
+        }
+        pool.join();
+
+        return executed;
+    }
+
+    // Returns whether join() waited for the paused pool to be stopped, its task being left pending
+    bool joinStoppedPool() {
+        std::atomic_bool stopping = {false};
+        ThreadPool<void> pool(2, "JoinTest");
+        pool.pause();
+        pool.addTask(make_callable([]() {}));
+
+        std::thread stopper([&pool, &stopping]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            stopping = true;
+            pool.stop();
+        });
+        pool.join();
+        bool stopped = stopping;
+        stopper.join();
+
+        return stopped;
+    }
+}
+
+int main() {
+    double total = 0;
+    for(int i = 0; i < Runs; ++i) {
+        PetriNet petriNet("JoinTest");
+        Action &begin = petriNet.addAction(Action(1, "Begin", make_action_callable([]() { return actionResult_t(0); }), 1), true);
+        Action &end = petriNet.addAction(Action(2, "End", make_action_callable([]() { return actionResult_t(0); }), 1));
+        begin.addTransition(3, "", end, make_transition_callable([](actionResult_t) { return true; })).setPure(true);
+        petriNet.freeze();
+
+        auto const start = ClockType::now();
+        petriNet.run();
+        petriNet.join();
+        total += std::chrono::duration<double, std::micro>(ClockType::now() - start).count();
+    }
+    double average = total / Runs;
+    std::printf("%.0fus per run and join\n", average);
+
+    PetriNet petriNet("JoinTest");
+    Action &wait = petriNet.addAction(Action(1, "Wait", make_action_callable([]() { return actionResult_t(0); }), 1), true);
+    Action &end = petriNet.addAction(Action(2, "End", make_action_callable([]() { return actionResult_t(0); }), 1));
+    wait.addTransition(3, "", end, make_transition_callable([](actionResult_t) { return false; }));
+    petriNet.run();
+
+    auto const start = ClockType::now();
+    bool joined = petriNet.joinFor(std::chrono::milliseconds(50));
+    auto waited = ClockType::now() - start;
+    std::printf("joinFor returned %s after %.0fms\n", joined ? "true" : "false",
+                std::chrono::duration<double, std::milli>(waited).count());
+    petriNet.stop();
+
+    int executed = joinPool();
+    bool stopped = joinStoppedPool();
+    std::printf("ThreadPool::join returned after %d tasks of %d, and %s stopping\n", executed, Tasks,
+                stopped ? "when" : "before");
+
+    if(average >= 1000 || joined || waited < std::chrono::milliseconds(50) || !petriNet.joinFor(std::chrono::milliseconds(0)) ||
+       executed != Tasks || !stopped) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  RestartTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks that a standalone net can be stopped while running, reset and run again to completion
+// several times, and that a stopped thread pool, even by one of its own tasks, runs the tasks added
+// once it has been started again.
+
+#include "../Action.h"
+#include "../Atomic.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include "../detail/WorkStealingThreadPool.h"
+#include "TestUtils.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+    using namespace Petri;
+
+    enum : std::uint_fast32_t { Counter, Limit };
+    enum : std::int64_t { Unreachable = std::int64_t(1) << 60, Iterations = 1000 };
+
+    void waitFor(PetriNet &petriNet, std::int64_t count) {
+        while(petriNet.getVariable(Counter).load() < count) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+int main() {
+    PetriNet petriNet("RestartTest");
+    petriNet.addVariable(Counter);
+    petriNet.addVariable(Limit);
+    petriNet.getVariable(Limit).store(Unreachable);
+
+    // The loop increments the counter until it reaches the limit
+    Action &loop = petriNet.addAction(Action(1, "Loop", make_param_action_callable([](PetriNet &pn) {
+                                                 ++pn.getVariable(Counter).value();
+                                                 return actionResult_t(0);
+                                             }),
+                                             1),
+                                      true);
+    loop.addVariable(Counter);
+    Action &end = petriNet.addAction(Action(2, "End", make_action_callable([]() { return actionResult_t(0); }), 1));
+    auto &again = loop.addTransition(3, "Again", loop, make_param_transition_callable([](PetriNet &pn, actionResult_t) {
+                                         return pn.getVariable(Counter).value() < pn.getVariable(Limit).value();
+                                     }));
+    again.addVariable(Counter);
+    again.addVariable(Limit);
+    again.setPure(true);
+    auto &over = loop.addTransition(4, "Over", end, make_param_transition_callable([](PetriNet &pn, actionResult_t) {
+                                        return pn.getVariable(Counter).value() >= pn.getVariable(Limit).value();
+                                    }));
+    over.addVariable(Counter);
+    over.addVariable(Limit);
+    over.setPure(true);
+
+    for(int run = 0; run < 3; ++run) {
+        petriNet.run();
+        waitFor(petriNet, 10);
+        petriNet.stop();
+        check(!petriNet.running(), "net stopped while running");
+        auto const stopped = petriNet.getVariable(Counter).load();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        check(petriNet.getVariable(Counter).load() == stopped, "no state left running once stopped");
+
+        petriNet.reset();
+        check(petriNet.getVariable(Counter).load() == 0 && petriNet.getVariable(Limit).load() == Unreachable,
+              "variables reset to their initial values");
+        petriNet.getVariable(Limit).store(Iterations);
+        petriNet.run();
+        petriNet.join();
+        check(petriNet.getVariable(Counter).load() == Iterations, "net run again to completion after a reset");
+        petriNet.reset();
+        petriNet.getVariable(Limit).store(Unreachable);
+    }
+
+    WorkStealingThreadPool<void> pool(2, "RestartTest");
+    std::atomic_int executed = {0};
+    pool.addTask([&executed]() { ++executed; });
+    pool.join();
+    pool.stop();
+    pool.start(2);
+    pool.addTask([&executed]() { ++executed; });
+    pool.join();
+    check(executed == 2 && pool.threadCount() == 2, "tasks run by a pool started again after being stopped");
+
+    pool.addTask([&pool]() { pool.stop(); });
+    pool.join();
+    pool.start(3);
+    pool.addTask([&executed]() { ++executed; });
+    pool.join();
+    check(executed == 3 && pool.threadCount() == 3, "tasks run by a pool started again after being stopped by a task");
+    pool.stop();
+
+    if(failures) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
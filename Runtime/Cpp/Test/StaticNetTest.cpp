@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  StaticNetTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks that a petri net described by constant tables, as generated in the static mode, executes
+// like the same net built with addAction() and addTransition(): a loop on a variable and a dispatch
+// on the result of an action, forked and joined again through a relay action. The net is then reset
+// and run again, and shared by a PetriNetPrototype. The same tables are finally added to a regular
+// net with PetriNet::build(), as done by the generated fill().
+
+#include "../Atomic.h"
+#include "../PetriNetPrototype.h"
+#include "../StaticPetriNet.h"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+    using namespace Petri;
+
+    enum : std::uint_fast32_t { Counter = 0 };
+    enum : std::int64_t { Loops = 100 };
+
+    std::atomic_int ends = {0};
+
+    actionResult_t increment(PetriNet &pn) {
+        ++pn.getVariable(Counter).value();
+        return 0;
+    }
+
+    actionResult_t returnTwo(PetriNet &) {
+        return 2;
+    }
+
+    actionResult_t end(PetriNet &) {
+        ++ends;
+        return 0;
+    }
+
+    bool loopAgain(PetriNet &pn, actionResult_t) {
+        return pn.getVariable(Counter).value() < Loops;
+    }
+
+    bool loopDone(PetriNet &pn, actionResult_t) {
+        return pn.getVariable(Counter).value() >= Loops;
+    }
+
+    bool unexpected(PetriNet &, actionResult_t) {
+        return false;
+    }
+
+    enum Actions : std::uint32_t { Loop, Fork, Dispatch, Wrong, Relay, Join, End, ActionsCount };
+
+    constexpr std::uint_fast32_t netVariables[] = {Counter};
+    constexpr StaticVariable variables[] = {
+        {Counter, VariableAccess::Exclusive},
+        {Counter, VariableAccess::Shared},
+        {Counter, VariableAccess::Shared},
+    };
+
+    constexpr StaticTransition transitions[] = {
+        // Loop
+        {1, "again", Loop, &loopAgain, true, false, 0, 1, 2},
+        {2, "done", Relay, &loopDone, true, false, 0, 2, 3},
+        // Fork
+        {3, "fork", Dispatch, &StaticNet::alwaysFulfilled, true, false, 0, 0, 0},
+        // Dispatch, whose conditions are never evaluated as they expect a result
+        {4, "one", Wrong, &unexpected, true, true, 1, 0, 0},
+        {5, "two", Relay, &unexpected, true, true, 2, 0, 0},
+        // Relay, so that the states feeding the join do not wait for their other transitions
+        {6, "relay", Join, &StaticNet::alwaysFulfilled, true, false, 0, 0, 0},
+        // Join
+        {7, "end", End, &StaticNet::alwaysFulfilled, true, false, 0, 0, 0},
+    };
+
+    constexpr StaticAction actions[] = {
+        {10, "Loop", &increment, 1, true, 0, 2, 0, 1},
+        {11, "Fork", &StaticNet::emptyAction, 1, true, 2, 3, 0, 0},
+        {12, "Dispatch", &returnTwo, 1, false, 3, 5, 0, 0},
+        {13, "Wrong", &end, 1, false, 5, 5, 0, 0},
+        {14, "Relay", &StaticNet::emptyAction, 1, false, 5, 6, 0, 0},
+        {15, "Join", &StaticNet::emptyAction, 2, false, 6, 7, 0, 0},
+        {16, "End", &end, 1, false, 7, 7, 0, 0},
+    };
+
+    constexpr StaticNet net = {actions, ActionsCount, transitions, 7, variables, 3, netVariables, 1};
+
+    bool runOnce(PetriNet &pn, int expectedEnds) {
+        pn.run();
+        pn.join();
+        return pn.getVariable(Counter).value() == Loops && ends == expectedEnds;
+    }
+}
+
+int main() {
+    int failures = 0;
+
+    StaticPetriNet<net> petriNet("StaticNetTest");
+    failures += !runOnce(petriNet, 1);
+
+    petriNet.reset();
+    failures += petriNet.getVariable(Counter).value() != 0;
+    failures += !runOnce(petriNet, 2);
+
+    PetriNetPrototype prototype(std::make_unique<StaticPetriNet<net>>("StaticNetTest"));
+    std::vector<std::unique_ptr<PetriNet>> instances;
+    for(int i = 0; i < 8; ++i) {
+        instances.push_back(prototype.createInstance());
+        instances.back()->run();
+    }
+    for(auto &instance : instances) {
+        instance->join();
+        failures += instance->getVariable(Counter).value() != Loops;
+    }
+
+    PetriNet built("StaticNetTest");
+    built.build(net);
+    failures += !runOnce(built, 11);
+
+    std::printf("%d executions ended, %d failures\n", ends.load(), failures);
+    if(failures != 0 || ends != 11) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
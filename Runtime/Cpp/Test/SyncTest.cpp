@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  SyncTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks the synchronization actions, as in the CppSync example: a fork into many branches, each of
+// them incrementing its own counter, converges on a join requiring one token per branch, and this
+// is repeated many times. The join must be enabled exactly once per iteration, after all of the
+// branches, and no token must be left over.
+
+#include "../Action.h"
+#include "../Atomic.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include <cstdio>
+#include <string>
+
+namespace {
+    using namespace Petri;
+
+    enum : std::int64_t { Iterations = 2000 };
+    enum { Branches = 16, Iteration = Branches };
+}
+
+int main() {
+    PetriNet petriNet("SyncTest");
+    for(int i = 0; i <= Branches; ++i) {
+        petriNet.addVariable(i);
+    }
+
+    Action &fork = petriNet.addAction(Action(1, "Fork", make_action_callable([]() { return actionResult_t(0); }), 1), true);
+    Action &join = petriNet.addAction(Action(2, "Join", make_param_action_callable([](PetriNet &pn) {
+                                                 auto iteration = ++pn.getVariable(Iteration).value();
+                                                 for(int i = 0; i < Branches; ++i) {
+                                                     if(pn.getVariable(i).value() != iteration) {
+                                                         std::printf("Join enabled before branch %d\n", i);
+                                                     }
+                                                 }
+                                                 return actionResult_t(iteration < Iterations ? 0 : 1);
+                                             }),
+                                             Branches));
+    for(int i = 0; i < Branches; ++i) {
+        join.addVariable(i);
+    }
+    join.addVariable(Iteration);
+    Action &end = petriNet.addAction(Action(3, "End", make_action_callable([]() { return actionResult_t(0); }), 1));
+
+    auto always = make_transition_callable([](actionResult_t) { return true; });
+    for(int i = 0; i < Branches; ++i) {
+        Action &branch = petriNet.addAction(Action(10 + i, "Branch" + std::to_string(i), make_param_action_callable([i](PetriNet &pn) {
+                                                       ++pn.getVariable(i).value();
+                                                       return actionResult_t(0);
+                                                   }),
+                                                   1));
+        branch.addVariable(i);
+        fork.addTransition(100 + i, "", branch, always).setPure(true);
+        branch.addTransition(200 + i, "", join, always).setPure(true);
+    }
+
+    auto &loop = join.addTransition(300, "", fork, make_transition_callable([](actionResult_t r) { return r == 0; }));
+    loop.setPure(true);
+    loop.setExpectedResult(0);
+    auto &exit = join.addTransition(301, "", end, make_transition_callable([](actionResult_t r) { return r == 1; }));
+    exit.setPure(true);
+    exit.setExpectedResult(1);
+
+    petriNet.run();
+    petriNet.join();
+
+    auto iterations = petriNet.getVariable(Iteration).value();
+    std::printf("%ld iterations of %d branches, %zu tokens left\n", long(iterations), int(Branches), join.currentTokens());
+    if(iterations != Iterations || join.currentTokens() != 0) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+    for(int i = 0; i < Branches; ++i) {
+        if(petriNet.getVariable(i).value() != Iterations) {
+            std::printf("FAILED\n");
+            return 1;
+        }
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+//
+//  TestUtils.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// The helpers shared by the tests: the allocations of the whole process are counted by replacing
+// the global operator new, and failed checks are reported. As it defines the replacement operators,
+// this header must only be included by the single source file of a test.
+
+#ifndef Petri_TestUtils_h
+#define Petri_TestUtils_h
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // The number of allocations since the start of the test
+    std::atomic_long allocations = {0};
+
+    // The number of bytes allocated through operator new since the start of the test
+    std::atomic_size_t allocatedBytes = {0};
+
+    // The number of failed checks
+    int failures = 0;
+
+    /**
+     * Reports a failed check.
+     * @param condition The condition which must hold
+     * @param what What is checked, printed when the condition does not hold
+     */
+    inline void check(bool condition, char const *what) {
+        if(!condition) {
+            std::printf("%s\n", what);
+            ++failures;
+        }
+    }
+
+    inline void *allocate(std::size_t size) {
+        ++allocations;
+        allocatedBytes += size;
+        if(void *p = std::malloc(size ? size : 1)) {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+void *operator new(std::size_t size) {
+    return allocate(size);
+}
+void *operator new[](std::size_t size) {
+    return allocate(size);
+}
+void *operator new(std::size_t size, std::nothrow_t const &) noexcept {
+    ++allocations;
+    return std::malloc(size ? size : 1);
+}
+void *operator new[](std::size_t size, std::nothrow_t const &) noexcept {
+    ++allocations;
+    return std::malloc(size ? size : 1);
+}
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  VariableTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks the variables designated by large ids, which are looked up in the sparse map of the
+// variable table instead of a directory covering all the smaller ids: they are added, modified by
+// the actions and observed by the transitions of a running net like the small ones.
+
+#include "../Action.h"
+#include "../Atomic.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include "TestUtils.h"
+#include <cstdio>
+
+namespace {
+    using namespace Petri;
+
+    enum : std::uint_fast32_t { Small = 1, LastDense = 65535, FirstSparse = 65536, Largest = 0xFFFFFFFF };
+    enum : std::int64_t { Iterations = 100 };
+}
+
+int main() {
+    PetriNet petriNet("VariableTest");
+    for(auto id : {Small, LastDense, FirstSparse}) {
+        petriNet.addVariable(id);
+    }
+    auto before = allocatedBytes.load();
+    petriNet.addVariable(Largest);
+    check(allocatedBytes - before < 4096, "a large id must not allocate a directory covering the smaller ids");
+    petriNet.addVariable(Largest - 1);
+    check(&petriNet.getVariable(Largest) != &petriNet.getVariable(Largest - 1), "distinct neighbouring variables");
+    petriNet.getVariable(FirstSparse).value() = 7;
+    check(petriNet.getVariable(FirstSparse).value() == 7 && petriNet.getVariable(LastDense).value() == 0,
+          "variables on both sides of the dense ids");
+
+    // Each iteration of the loop increments the largest variable, until a pure transition observing
+    // it leads to the end
+    Action &loop = petriNet.addAction(Action(1, "Loop", make_param_action_callable([](PetriNet &pn) {
+                                                 ++pn.getVariable(Largest).value();
+                                                 ++pn.getVariable(Small).value();
+                                                 return actionResult_t(0);
+                                             }),
+                                             1),
+                                      true);
+    loop.addVariable(Largest);
+    loop.addVariable(Small);
+    Action &end = petriNet.addAction(Action(2, "End", make_action_callable([]() { return actionResult_t(0); }), 1));
+    auto &again = loop.addTransition(3, "Again", loop, make_param_transition_callable([](PetriNet &pn, actionResult_t) {
+                                         return pn.getVariable(Largest).value() < Iterations;
+                                     }));
+    again.addVariable(Largest);
+    again.setPure(true);
+    auto &over = loop.addTransition(4, "Over", end, make_param_transition_callable([](PetriNet &pn, actionResult_t) {
+                                        return pn.getVariable(Largest).value() >= Iterations;
+                                    }));
+    over.addVariable(Largest);
+    over.setPure(true);
+
+    petriNet.run();
+    petriNet.join();
+    check(petriNet.getVariable(Largest).value() == Iterations, "variable of the largest id modified by the net");
+    check(petriNet.getVariable(Small).value() == Iterations, "small variable modified by the net");
+
+    if(failures) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+//
+//  WakeTest.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+// Checks that a state woken up by a variable change runs right away on an idle worker: an action
+// modifies a variable a parked state waits for, and then goes on with a chain of blocking actions on
+// the same worker. The woken state must not wait for the end of that chain.
+
+#include "../Action.h"
+#include "../Atomic.h"
+#include "../PetriNet.h"
+#include "../Transition.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace {
+    using namespace Petri;
+    using ClockType = std::chrono::steady_clock;
+
+    enum { Flag = 0 };
+    constexpr auto BlockDuration = std::chrono::milliseconds(50);
+
+    ClockType::time_point setDate, wokenDate;
+
+    actionResult_t block() {
+        std::this_thread::sleep_for(BlockDuration);
+        return 0;
+    }
+
+    actionResult_t nothing() {
+        return 0;
+    }
+}
+
+int main() {
+    PetriNet petriNet("WakeTest");
+    petriNet.addVariable(Flag);
+
+    // Lets the waiter park before the flag is set, without holding the lock of the flag
+    Action &delay = petriNet.addAction(Action(1, "Delay", &block, 1), true);
+    Action &setter = petriNet.addAction(Action(2, "Setter", make_param_action_callable([](PetriNet &pn) {
+                                                   pn.getVariable(Flag).value() = 1;
+                                                   setDate = ClockType::now();
+                                                   return actionResult_t(0);
+                                               }),
+                                               1));
+    setter.addVariable(Flag);
+    Action &waiter = petriNet.addAction(Action(3, "Waiter", &nothing, 1), true);
+    Action &woken = petriNet.addAction(Action(4, "Woken", make_action_callable([]() {
+                                                  wokenDate = ClockType::now();
+                                                  return actionResult_t(0);
+                                              }),
+                                              1));
+    Action &first = petriNet.addAction(Action(5, "First", &block, 1));
+    Action &second = petriNet.addAction(Action(6, "Second", &block, 1));
+    Action &third = petriNet.addAction(Action(7, "Third", &block, 1));
+
+    auto always = make_transition_callable([](actionResult_t) { return true; });
+    Transition &flagSet = waiter.addTransition(8, "", woken, make_param_transition_callable([](PetriNet &pn, actionResult_t) {
+                                                   return pn.getVariable(Flag).value() == 1;
+                                               }));
+    flagSet.addVariable(Flag);
+    flagSet.setPure(true);
+    delay.addTransition(9, "", setter, always).setPure(true);
+    setter.addTransition(10, "", first, always).setPure(true);
+    first.addTransition(11, "", second, always).setPure(true);
+    second.addTransition(12, "", third, always).setPure(true);
+
+    petriNet.run();
+    petriNet.join();
+
+    auto const latency = wokenDate - setDate;
+    std::printf("Woken up %.1fms after the change, behind a chain of 3 actions of %lldms\n",
+                std::chrono::duration<double, std::milli>(latency).count(),
+                static_cast<long long>(BlockDuration.count()));
+
+    if(latency >= BlockDuration / 2) {
+        std::printf("FAILED\n");
+        return 1;
+    }
+
+    std::printf("OK\n");
+    return 0;
+}
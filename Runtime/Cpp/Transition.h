@@ -39,23 +39,29 @@ namespace Petri {
     using namespace std::chrono_literals;
 
     class Action;
+    class InternedName;
     class PetriNet;
 
-    using TransitionCallableBase = CallableBase<bool, actionResult_t>;
-    using ParametrizedTransitionCallableBase = CallableBase<bool, PetriNet &, actionResult_t>;
+    using TransitionCallable = InlineCallable<bool(actionResult_t)>;
+    using ParametrizedTransitionCallable = InlineCallable<bool(PetriNet &, actionResult_t)>;
+    using TransitionCallableBase [[deprecated("Use TransitionCallable instead")]] = TransitionCallable;
+    using ParametrizedTransitionCallableBase [[deprecated("Use ParametrizedTransitionCallable instead")]] = ParametrizedTransitionCallable;
 
     template <typename CallableType>
     auto make_transition_callable(CallableType &&c) {
-        return Callable<CallableType, std::result_of_t<CallableType(actionResult_t)>, actionResult_t>(c);
+        return TransitionCallable(std::forward<CallableType>(c));
     }
 
     template <typename CallableType>
     auto make_param_transition_callable(CallableType &&c) {
-        return Callable<CallableType, std::result_of_t<CallableType(PetriNet &, actionResult_t)>, PetriNet &, actionResult_t>(c);
+        return ParametrizedTransitionCallable(std::forward<CallableType>(c));
     }
 
     /**
      * A transition linking 2 Action, composing a PetriNet.
+     * On a 64 bit platform with libstdc++, a transition takes 64 bytes in the list of its Action
+     * and 112 bytes of internals in the arena of its net, its name and its variables being stored as
+     * those of an Action.
      */
     class Transition : public Entity {
         friend class Petri::Action;
@@ -76,14 +82,14 @@ namespace Petri {
          * Returns the condition associated to the Transition
          * @return The condition associated to the Transition
          */
-        ParametrizedTransitionCallableBase const &condition() const noexcept;
+        ParametrizedTransitionCallable const &condition() const noexcept;
 
         /**
          * Changes the condition associated to the Transition
          * @param test The new condition to associate to the Transition
          */
-        void setCondition(TransitionCallableBase const &test);
-        void setCondition(ParametrizedTransitionCallableBase const &test);
+        void setCondition(TransitionCallable const &test);
+        void setCondition(ParametrizedTransitionCallable const &test);
 
         /**
          * Gets the Action 'previous', the starting point of the Transition.
@@ -124,15 +130,65 @@ namespace Petri {
          */
         void setDelayBetweenEvaluation(std::chrono::nanoseconds delay);
 
+        /**
+         * Checks whether the condition of the Transition is pure, i.e. whether it only depends on
+         * the result of the Action 'previous' and on the Atomic variables added with
+         * addVariable(). A pure Transition is only re-evaluated when one of these variables is
+         * changed, whereas the other ones are polled every delayBetweenEvaluation().
+         * A pure Transition without any variable only depends on the result of the Action
+         * 'previous', and is thus evaluated only once: if it is not fulfilled then, it is never
+         * crossed, and a state whose remaining transitions are all in this case ends.
+         * @return Whether the Transition is pure.
+         */
+        bool isPure() const noexcept;
+
+        /**
+         * Changes the purity of the Transition. Marking a condition which reads some external state
+         * as pure may prevent the Transition from ever being crossed.
+         * @param pure Whether the Transition is pure.
+         */
+        void setPure(bool pure) noexcept;
+
+        /**
+         * Checks whether the Transition is known to be fulfilled exactly when the result of the
+         * Action 'previous' is equal to a given value, as set by setExpectedResult().
+         * @return Whether the Transition has an expected result.
+         */
+        bool hasExpectedResult() const noexcept;
+
+        /**
+         * Gets the value the result of the Action 'previous' is compared to by the condition.
+         * @return The expected result, which is only meaningful if hasExpectedResult() is true.
+         */
+        actionResult_t expectedResult() const noexcept;
+
+        /**
+         * Tells that the condition of the Transition is the comparison of the result of the Action
+         * 'previous' with the given value. The runtime then looks the result up in a table of the
+         * transitions of the Action instead of evaluating their conditions one after the other, so
+         * the condition is not called anymore and must be consistent with this value.
+         * @param result The value of the result which fulfills the Transition.
+         */
+        void setExpectedResult(actionResult_t result) noexcept;
+
     private:
-        Transition(Action &previous, Action &next);
-        Transition(uint64_t id, std::string const &name, Action &previous, Action &next, ParametrizedTransitionCallableBase const &cond);
+        Transition(Action &previous, Action &next, Arena *arena);
+        // The name is already interned in the NameTable
+        Transition(uint64_t id,
+                   InternedName &&name,
+                   Action &previous,
+                   Action &next,
+                   ParametrizedTransitionCallable const &cond,
+                   Arena *arena);
 
         void setPrevious(Action &previous) noexcept;
         void setNext(Action &next) noexcept;
 
         struct Internals;
-        std::unique_ptr<Internals> _internals;
+        struct InternalsDeleter {
+            void operator()(Internals *internals) const noexcept;
+        };
+        std::unique_ptr<Internals, InternalsDeleter> _internals;
     };
 }
 
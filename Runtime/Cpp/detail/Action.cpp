@@ -28,37 +28,45 @@
 //
 
 #include "../Action.h"
+#include "NameTable.h"
+#include <cstring>
 #include <list>
-#include <mutex>
 
 namespace Petri {
 
     struct Action::Internals {
-        Internals() = default;
-        Internals(std::string const &name, size_t requiredTokens)
-                : _name(name)
+        Internals(Arena *arena)
+                : Internals(arena, InternedName(), 1) {}
+        Internals(Arena *arena, InternedName name, size_t requiredTokens)
+                : _arena(arena)
+                , _transitions(ArenaAllocator<Transition>(arena))
+                , _transitionsLeadingToMe(ArenaAllocator<std::reference_wrapper<Transition>>(arena))
+                , _name(std::move(name))
                 , _requiredTokens(requiredTokens) {}
-        std::list<Transition> _transitions;
-        std::list<std::reference_wrapper<Transition>> _transitionsLeadingToMe;
-        std::unique_ptr<ParametrizedActionCallableBase> _action;
-        std::string _name;
-        std::size_t _requiredTokens = 1;
-
-        std::size_t _currentTokens = 0;
-        std::mutex _tokensMutex;
+
+        // The arena the internals are allocated from, if any
+        Arena *_arena;
+        TransitionList _transitions;
+        std::list<std::reference_wrapper<Transition>, ArenaAllocator<std::reference_wrapper<Transition>>> _transitionsLeadingToMe;
+        ParametrizedActionCallable _action;
+        InternedName _name;
+        std::size_t _requiredTokens;
+
+        std::atomic_size_t _currentTokens = {0};
+        std::atomic_size_t _activations = {0};
     };
 
     Action::Action()
             : Entity(0)
-            , _internals(std::make_unique<Internals>()) {}
+            , _internals(new Internals(nullptr)) {}
 
     /**
      * Creates an empty action, associated to a copy of the specified Callable.
      * @param action The Callable which will be copied
      */
-    Action::Action(uint64_t id, std::string const &name, ActionCallableBase const &action, size_t requiredTokens)
+    Action::Action(uint64_t id, std::string const &name, ActionCallable const &action, size_t requiredTokens)
             : Entity(id)
-            , _internals(std::make_unique<Internals>(name, requiredTokens)) {
+            , _internals(new Internals(nullptr, InternedName(name), requiredTokens)) {
         this->setAction(action);
     }
     Action::Action(uint64_t id, std::string const &name, actionResult_t (*action)(), size_t requiredTokens)
@@ -68,15 +76,21 @@ namespace Petri {
      * Creates an empty action, associated to a copy of the specified Callable.
      * @param action The Callable which will be copied
      */
-    Action::Action(uint64_t id, std::string const &name, ParametrizedActionCallableBase const &action, size_t requiredTokens)
+    Action::Action(uint64_t id, std::string const &name, ParametrizedActionCallable const &action, size_t requiredTokens)
             : Entity(id)
-            , _internals(std::make_unique<Internals>(name, requiredTokens)) {
+            , _internals(new Internals(nullptr, InternedName(name), requiredTokens)) {
         this->setAction(action);
     }
     Action::Action(uint64_t id, std::string const &name, actionResult_t (*action)(PetriNet &), size_t requiredTokens)
             : Action(id, name, make_param_action_callable(action), requiredTokens) {}
 
-    Action::Action(Action &&a) noexcept : Entity(a.ID()), _internals(std::move(a._internals)) {
+    Action::Action(uint64_t id, char const *name, ParametrizedActionCallable const &action, size_t requiredTokens, Arena &arena)
+            : Entity(id, &arena)
+            , _internals(arena.create<Internals>(&arena, InternedName(name, std::strlen(name)), requiredTokens)) {
+        this->setAction(action);
+    }
+
+    Action::Action(Action &&a) noexcept : Entity(std::move(a)), _internals(std::move(a._internals)) {
         for(auto &t : _internals->_transitions) {
             t.setPrevious(*this);
         }
@@ -85,6 +99,29 @@ namespace Petri {
         }
     }
 
+    void Action::InternalsDeleter::operator()(Internals *internals) const noexcept {
+        if(internals->_arena) {
+            internals->~Internals();
+        } else {
+            delete internals;
+        }
+    }
+
+    void Action::moveTo(Arena &arena) {
+        if(_internals->_arena || !_internals->_transitions.empty() || !_internals->_transitionsLeadingToMe.empty()) {
+            return;
+        }
+
+        auto &heap = *_internals;
+        std::unique_ptr<Internals, InternalsDeleter> internals(arena.create<Internals>(&arena, std::move(heap._name), heap._requiredTokens));
+        internals->_action = std::move(heap._action);
+        internals->_currentTokens = heap._currentTokens.load();
+        internals->_activations = heap._activations.load();
+        _internals = std::move(internals);
+
+        this->moveVariablesTo(arena);
+    }
+
     Action::~Action() = default;
     Transition &Action::addTransition(Transition t) {
         _internals->_transitions.push_back(std::move(t));
@@ -96,23 +133,23 @@ namespace Petri {
     }
 
     Transition &Action::addTransition(Action &next) {
-        return this->addTransition(Transition(*this, next));
+        return this->addTransition(Transition(*this, next, _internals->_arena));
     }
 
     Transition &Action::addTransition(uint64_t id,
                                       std::string const &name,
                                       Action &next,
-                                      ParametrizedTransitionCallableBase const &cond) {
-        return this->addTransition(Transition(id, name, *this, next, cond));
+                                      ParametrizedTransitionCallable const &cond) {
+        return this->addTransition(id, InternedName(name), next, cond);
+    }
+    Transition &Action::addTransition(uint64_t id, InternedName &&name, Action &next, ParametrizedTransitionCallable const &cond) {
+        return this->addTransition(Transition(id, std::move(name), *this, next, cond, _internals->_arena));
     }
     Transition &
-    Action::addTransition(uint64_t id, std::string const &name, Action &next, TransitionCallableBase const &cond) {
-        auto copy = cond.copy_ptr();
-        auto shared_copy = std::shared_ptr<TransitionCallableBase>(copy.release());
-        return this->addTransition(
-        id, name, next, make_param_transition_callable(std::move([shared_copy](PetriNet &, actionResult_t a) {
-            return shared_copy->operator()(a);
-        })));
+    Action::addTransition(uint64_t id, std::string const &name, Action &next, TransitionCallable const &cond) {
+        auto &transition = this->addTransition(id, name, next, ParametrizedTransitionCallable());
+        transition.setCondition(cond);
+        return transition;
     }
     Transition &Action::addTransition(uint64_t id, std::string const &name, Action &next, bool (*cond)(actionResult_t)) {
         return addTransition(id, name, next, make_transition_callable(cond));
@@ -127,19 +164,21 @@ namespace Petri {
      * this method!
      * @return The Callable of the Action
      */
-    ParametrizedActionCallableBase &Action::action() noexcept {
-        return *_internals->_action;
+    ParametrizedActionCallable const &Action::action() const noexcept {
+        return _internals->_action;
     }
 
     /**
      * Changes the Callable associated to the Action
      * @param action The Callable which will be copied and put in the Action
      */
-    void Action::setAction(ActionCallableBase const &action) {
-        auto copy = action.copy_ptr();
-        auto shared_copy = std::shared_ptr<ActionCallableBase>(copy.release());
-        this->setAction(make_param_action_callable(
-        std::move([shared_copy](PetriNet &) { return shared_copy->operator()(); })));
+    void Action::setAction(ActionCallable const &action) {
+        // A plain function is captured on its own, so that the wrapper is stored inline
+        if(auto function = action.function()) {
+            this->setAction(make_param_action_callable([function](PetriNet &) { return function(); }));
+        } else {
+            this->setAction(make_param_action_callable([action](PetriNet &) { return action(); }));
+        }
     }
     void Action::setAction(actionResult_t (*action)()) {
         this->setAction(make_action_callable(action));
@@ -149,8 +188,8 @@ namespace Petri {
      * Changes the Callable associated to the Action
      * @param action The Callable which will be copied and put in the Action
      */
-    void Action::setAction(ParametrizedActionCallableBase const &action) {
-        _internals->_action = action.copy_ptr();
+    void Action::setAction(ParametrizedActionCallable const &action) {
+        _internals->_action = action;
     }
     void Action::setAction(actionResult_t (*action)(PetriNet &)) {
         this->setAction(make_param_action_callable(action));
@@ -181,12 +220,16 @@ namespace Petri {
         return _internals->_currentTokens;
     }
 
-    std::size_t &Action::currentTokensRef() noexcept {
+    std::atomic_size_t &Action::currentTokensRef() noexcept {
         return _internals->_currentTokens;
     }
 
-    std::mutex &Action::tokensMutex() noexcept {
-        return _internals->_tokensMutex;
+    std::size_t Action::activations() noexcept {
+        return _internals->_activations;
+    }
+
+    std::atomic_size_t &Action::activationsRef() noexcept {
+        return _internals->_activations;
     }
 
     /**
@@ -194,21 +237,21 @@ namespace Petri {
      * @return The name of the Action
      */
     std::string const &Action::name() const noexcept {
-        return _internals->_name;
+        return *_internals->_name;
     }
 
     /**
      * Sets the name of the Action
      * @param name The name of the Action
      */
-    void Action::setName(std::string const &name) noexcept(std::is_nothrow_move_constructible<std::string>::value) {
-        _internals->_name = name;
+    void Action::setName(std::string const &name) {
+        _internals->_name = InternedName(name);
     }
 
     /**
      * Returns the transitions exiting the Action.
      */
-    std::list<Transition> const &Action::transitions() const noexcept {
+    Action::TransitionList const &Action::transitions() const noexcept {
         return _internals->_transitions;
     }
 }
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  Arena.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#include "../Arena.h"
+#include <algorithm>
+#include <new>
+
+namespace Petri {
+
+    namespace {
+        // The chunks double in size up to this limit, beyond which a net rather takes more chunks
+        constexpr std::size_t MinChunkSize = 4096;
+        constexpr std::size_t MaxChunkSize = 1 << 20;
+    }
+
+    void Arena::release() noexcept {
+        while(_chunks) {
+            auto previous = _chunks->previous;
+            ::operator delete(_chunks);
+            _chunks = previous;
+        }
+        _cursor = _end = nullptr;
+        _capacity = 0;
+    }
+
+    void *Arena::grow(std::size_t size, std::size_t alignment) {
+        auto const header = (sizeof(Chunk) + alignment - 1) & ~(alignment - 1);
+        auto const chunkSize = std::max(std::min(std::max(_capacity, MinChunkSize), MaxChunkSize), header + size);
+
+        auto chunk = static_cast<Chunk *>(::operator new(chunkSize));
+        chunk->previous = _chunks;
+        _chunks = chunk;
+        _capacity += chunkSize;
+
+        // A block larger than the usual chunks gets one for itself, and the current one is kept
+        auto const block = reinterpret_cast<unsigned char *>(chunk) + header;
+        if(chunkSize - header - size >= static_cast<std::size_t>(_end - _cursor)) {
+            _cursor = block + size;
+            _end = reinterpret_cast<unsigned char *>(chunk) + chunkSize;
+        }
+
+        return block;
+    }
+}
@@ -32,7 +32,7 @@
 #include "../DebugServer.h"
 #include "../PetriDynamicLib.h"
 #include "Socket.h"
-#include "ThreadPool.h"
+#include "WorkStealingThreadPool.h"
 #ifdef __clang__
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdocumentation"
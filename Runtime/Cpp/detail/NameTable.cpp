@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  NameTable.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#include "NameTable.h"
+#include <cstdint>
+#include <cstring>
+
+namespace Petri {
+
+    namespace {
+        // FNV-1a
+        std::size_t hashName(char const *name, std::size_t size) noexcept {
+            std::uint64_t hash = 14695981039346656037ull;
+            for(std::size_t i = 0; i < size; ++i) {
+                hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ull;
+            }
+            return static_cast<std::size_t>(hash);
+        }
+    }
+
+    NameTable &NameTable::instance() {
+        // Never destroyed, as the entities of the nets with static storage may outlive it otherwise
+        static NameTable *table = new NameTable;
+        return *table;
+    }
+
+    NameTable::NameTable()
+            : _slots(1024, Slot{0, nullptr}) {
+        _entries.push_back({std::string(), 0});
+        auto const hash = hashName("", 0);
+        _slots[this->find("", 0, hash)] = {hash, &_entries.front()};
+        _count = 1;
+    }
+
+    std::string const &NameTable::intern(char const *name, std::size_t size) {
+        auto const hash = hashName(name, size);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto slot = this->find(name, size, hash);
+        if(_slots[slot].entry == nullptr) {
+            // Kept at most half full, so that the probe sequences stay short
+            if(2 * (_count + 1) > _slots.size()) {
+                this->grow();
+                slot = this->find(name, size, hash);
+            }
+
+            Entry *entry;
+            if(_freeEntries.empty()) {
+                // Room is made for the entry to be freed without allocating in release()
+                _freeEntries.reserve(_entries.size() + 1);
+                _entries.push_back({std::string(name, size), 0});
+                entry = &_entries.back();
+            } else {
+                entry = _freeEntries.back();
+                entry->name.assign(name, size);
+                _freeEntries.pop_back();
+            }
+            _slots[slot] = {hash, entry};
+            ++_count;
+        }
+
+        ++_slots[slot].entry->references;
+        return _slots[slot].entry->name;
+    }
+
+    void NameTable::release(std::string const &name) noexcept {
+        if(&name == &this->empty()) {
+            return;
+        }
+
+        auto const hash = hashName(name.data(), name.size());
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto const slot = this->find(name.data(), name.size(), hash);
+        auto entry = _slots[slot].entry;
+        if(--entry->references == 0) {
+            this->erase(slot);
+            --_count;
+            std::string().swap(entry->name);
+            _freeEntries.push_back(entry);
+        }
+    }
+
+    std::size_t NameTable::find(char const *name, std::size_t size, std::size_t hash) const noexcept {
+        auto const mask = _slots.size() - 1;
+        for(auto slot = hash & mask;; slot = (slot + 1) & mask) {
+            auto const &s = _slots[slot];
+            if(s.entry == nullptr || (s.hash == hash && s.entry->name.size() == size &&
+                                      std::memcmp(s.entry->name.data(), name, size) == 0)) {
+                return slot;
+            }
+        }
+    }
+
+    void NameTable::grow() {
+        std::vector<Slot> slots(2 * _slots.size(), Slot{0, nullptr});
+        auto const mask = slots.size() - 1;
+        for(auto const &s : _slots) {
+            if(s.entry) {
+                auto slot = s.hash & mask;
+                while(slots[slot].entry) {
+                    slot = (slot + 1) & mask;
+                }
+                slots[slot] = s;
+            }
+        }
+        _slots.swap(slots);
+    }
+
+    void NameTable::erase(std::size_t slot) noexcept {
+        auto const mask = _slots.size() - 1;
+        for(auto next = (slot + 1) & mask; _slots[next].entry; next = (next + 1) & mask) {
+            // A name can fill the hole if the hole is between the first slot of its probe
+            // sequence and its current slot
+            auto const first = _slots[next].hash & mask;
+            if(((next - first) & mask) >= ((next - slot) & mask)) {
+                _slots[slot] = _slots[next];
+                slot = next;
+            }
+        }
+        _slots[slot] = {0, nullptr};
+    }
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  NameTable.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#ifndef Petri_NameTable_h
+#define Petri_NameTable_h
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Petri {
+
+    /**
+     * The names of the actions and transitions of all of the petri nets of the process, each of
+     * them being stored only once. An entity only keeps a pointer to its interned name, and creating
+     * a net whose names are already used by another one, as the instances of the same generated
+     * net, does not allocate any memory for them. Each name counts the entities using it, and is
+     * removed along with the last of them, so that the table grows with the number of distinct
+     * names in use, and not with the number of entities nor with the names used in the past.
+     */
+    class NameTable {
+    public:
+        /**
+         * Returns the name table shared by all of the petri nets of the process.
+         */
+        static NameTable &instance();
+
+        NameTable(NameTable const &) = delete;
+        NameTable &operator=(NameTable const &) = delete;
+
+        /**
+         * Returns the interned copy of a name, and adds a reference to it. It stays valid until
+         * the reference is released.
+         * @param name The name to intern
+         * @param size The length of the name
+         * @return The interned name
+         */
+        std::string const &intern(char const *name, std::size_t size);
+        std::string const &intern(std::string const &name) {
+            return this->intern(name.data(), name.size());
+        }
+
+        /**
+         * Releases a reference to an interned name, which is removed once it is not referenced
+         * anymore.
+         * @param name The interned name, as returned by intern()
+         */
+        void release(std::string const &name) noexcept;
+
+        /**
+         * Returns the number of names in the table, including the empty name.
+         */
+        std::size_t size() {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _count;
+        }
+
+        /**
+         * Returns the interned empty name, which is never removed and does not need to be released.
+         */
+        std::string const &empty() const noexcept {
+            return _entries.front().name;
+        }
+
+    private:
+        NameTable();
+
+        // Returns the slot of a name in _slots, which is either the slot holding it or the empty
+        // slot where it is to be inserted
+        std::size_t find(char const *name, std::size_t size, std::size_t hash) const noexcept;
+
+        // Doubles the number of slots
+        void grow();
+
+        // Empties a slot, moving back the following names of its probe sequence
+        void erase(std::size_t slot) noexcept;
+
+        struct Entry {
+            std::string name;
+            std::size_t references;
+        };
+
+        // An open addressing hash table, probed linearly, whose slots hold the hash of their name so
+        // that a lookup rarely has to compare the characters of another name
+        struct Slot {
+            std::size_t hash;
+            Entry *entry;
+        };
+
+        std::mutex _mutex;
+        // A deque never moves its elements, so that the interned names stay valid as it grows. The
+        // entries of the removed names are reused by the next ones.
+        std::deque<Entry> _entries;
+        std::vector<Entry *> _freeEntries;
+        std::vector<Slot> _slots;
+        // The number of names in _slots
+        std::size_t _count = 0;
+    };
+
+    /**
+     * A reference to a name interned in the NameTable, which is released when it is destroyed.
+     */
+    class InternedName {
+    public:
+        /**
+         * Refers to the empty name.
+         */
+        InternedName()
+                : _name(&NameTable::instance().empty()) {}
+
+        /**
+         * Interns a name.
+         * @param name The name to intern
+         * @param size The length of the name
+         */
+        InternedName(char const *name, std::size_t size)
+                : _name(&NameTable::instance().intern(name, size)) {}
+        explicit InternedName(std::string const &name)
+                : InternedName(name.data(), name.size()) {}
+
+        InternedName(InternedName &&name) noexcept
+                : _name(name._name) {
+            name._name = nullptr;
+        }
+        InternedName &operator=(InternedName &&name) noexcept {
+            std::swap(_name, name._name);
+            return *this;
+        }
+
+        ~InternedName() {
+            if(_name) {
+                NameTable::instance().release(*_name);
+            }
+        }
+
+        std::string const &operator*() const noexcept {
+            return *_name;
+        }
+
+    private:
+        std::string const *_name;
+    };
+}
+
+#endif
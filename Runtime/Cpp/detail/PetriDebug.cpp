@@ -38,22 +38,22 @@ namespace Petri {
         Internals(PetriDebug &pn, std::string const &name)
                 : PetriNet::Internals(pn, name) {}
 
-        void stateEnabled(Action &a) override;
-        void stateDisabled(Action &a) override;
+        void stateEnabled(FrozenNet::Index a) override;
+        void stateDisabled(FrozenNet::Index a) override;
 
         DebugServer *_observer = nullptr;
         std::unordered_map<uint64_t, Action *> _statesMap;
     };
 
-    void PetriDebug::Internals::stateEnabled(Action &a) {
+    void PetriDebug::Internals::stateEnabled(FrozenNet::Index a) {
         if(_observer) {
-            _observer->addActiveState(a);
+            _observer->addActiveState(*_frozen->actions[a]);
         }
     }
 
-    void PetriDebug::Internals::stateDisabled(Action &a) {
+    void PetriDebug::Internals::stateDisabled(FrozenNet::Index a) {
         if(_observer) {
-            _observer->removeActiveState(a);
+            _observer->removeActiveState(*_frozen->actions[a]);
         }
     }
 
@@ -88,7 +88,7 @@ namespace Petri {
             return nullptr;
     }
 
-    ThreadPool<void> &PetriDebug::actionsPool() {
-        return _internals->_actionsPool;
+    WorkStealingThreadPool<void> &PetriDebug::actionsPool() {
+        return *_internals->_actionsPool;
     }
 }
@@ -49,6 +49,18 @@ namespace Petri {
         return std::unique_ptr<PetriNet>(static_cast<PetriNet *>(ptr));
     }
 
+    std::shared_ptr<PetriNetPrototype> PetriDynamicLib::prototype() {
+        if(!_prototype) {
+            _prototype = std::make_shared<PetriNetPrototype>(this->create());
+        }
+
+        return _prototype;
+    }
+
+    std::unique_ptr<PetriNet> PetriDynamicLib::createInstance() {
+        return this->prototype()->createInstance();
+    }
+
     std::unique_ptr<PetriDebug> PetriDynamicLib::createDebug() {
         if(!this->loaded()) {
             throw std::runtime_error("PetriDynamicLib::createDebug: Dynamic library not loaded!");
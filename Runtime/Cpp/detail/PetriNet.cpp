@@ -28,15 +28,220 @@
 //
 
 #include "../PetriNet.h"
+#include "NameTable.h"
 #include "PetriNetImpl.h"
-#include "lock.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <utility>
 
 namespace Petri {
 
+    namespace {
+        /**
+         * Lowers the actions and transitions of a net into a FrozenNet, whether they are entities
+         * or the tables of a StaticNet. The actions are added in order, each one followed by its
+         * transitions in the order they are evaluated.
+         */
+        class FrozenNetBuilder {
+        public:
+            using Index = FrozenNet::Index;
+
+            // The variables are numbered in the order of their ids
+            FrozenNetBuilder(FrozenNet &net, VariableTable const &variables)
+                    : _net(net) {
+                variables.forEach([this](std::uint_fast32_t id, Atomic &variable) {
+                    _variableIndices.emplace(id, static_cast<Index>(_net.variableIds.size()));
+                    _net.variableIds.push_back(id);
+                    _net.initialValues.push_back(variable.load());
+                });
+            }
+
+            /**
+             * Adds an action, whose variables are given by forEachVariable(f), calling
+             * f(id, access) for each of them.
+             */
+            template <typename ForEachVariable>
+            void addAction(Action *action,
+                           ParametrizedActionCallable const &callable,
+                           std::size_t requiredTokens,
+                           bool active,
+                           ForEachVariable &&forEachVariable) {
+                this->endTransitions();
+
+                auto const index = static_cast<Index>(_net.actions.size());
+                if(active) {
+                    _net.initialActions.push_back(index);
+                }
+
+                _net.actions.push_back(action);
+                _net.callables.push_back(&callable);
+                _net.requiredTokens.push_back(requiredTokens);
+
+                _net.actionVariablesBegin.push_back(static_cast<Index>(_net.actionVariables.size()));
+                _net.actionLocksBegin.push_back(static_cast<Index>(_net.actionLocks.size()));
+                this->resolve(forEachVariable, _net.actionVariables, _net.actionLocks);
+
+                _net.transitionsBegin.push_back(static_cast<Index>(_net.conditions.size()));
+                _net.dispatchBegin.push_back(static_cast<Index>(_net.dispatch.size()));
+            }
+
+            /**
+             * Adds a transition to the last added action, see addAction().
+             */
+            template <typename ForEachVariable>
+            void addTransition(ParametrizedTransitionCallable const &condition,
+                               Index target,
+                               bool pure,
+                               std::chrono::nanoseconds delay,
+                               bool hasExpectedResult,
+                               actionResult_t expectedResult,
+                               ForEachVariable &&forEachVariable) {
+                _net.conditions.push_back(&condition);
+                _net.targets.push_back(target);
+                _net.pure.push_back(pure);
+                _net.delays.push_back(delay);
+
+                _net.transitionVariablesBegin.push_back(static_cast<Index>(_net.transitionVariables.size()));
+                _net.transitionLocksBegin.push_back(static_cast<Index>(_net.transitionLocks.size()));
+                this->resolve(forEachVariable, _net.transitionVariables, _net.transitionLocks);
+                _net.resultOnly.push_back(pure && _net.transitionVariablesBegin.back() == _net.transitionVariables.size());
+
+                _net.dispatched.push_back(hasExpectedResult);
+                if(hasExpectedResult) {
+                    _net.dispatch.push_back({expectedResult, static_cast<Index>(_net.conditions.size() - 1)});
+                }
+            }
+
+            // Closes the ranges of the net, and sorts its transitions by target
+            void finish() {
+                this->endTransitions();
+
+                _net.actionVariablesBegin.push_back(static_cast<Index>(_net.actionVariables.size()));
+                _net.actionLocksBegin.push_back(static_cast<Index>(_net.actionLocks.size()));
+                _net.transitionsBegin.push_back(static_cast<Index>(_net.conditions.size()));
+                _net.dispatchBegin.push_back(static_cast<Index>(_net.dispatch.size()));
+                _net.transitionVariablesBegin.push_back(static_cast<Index>(_net.transitionVariables.size()));
+                _net.transitionLocksBegin.push_back(static_cast<Index>(_net.transitionLocks.size()));
+
+                // Counting sort of the transitions by target
+                _net.predecessorsBegin.assign(_net.actions.size() + 1, 0);
+                for(auto target : _net.targets) {
+                    ++_net.predecessorsBegin[target + 1];
+                }
+                for(std::size_t i = 0; i < _net.actions.size(); ++i) {
+                    _net.predecessorsBegin[i + 1] += _net.predecessorsBegin[i];
+                }
+                _net.predecessors.resize(_net.targets.size());
+                std::vector<Index> position(_net.predecessorsBegin.begin(), _net.predecessorsBegin.end() - 1);
+                for(Index t = 0; t < _net.targets.size(); ++t) {
+                    _net.predecessors[position[_net.targets[t]]++] = t;
+                }
+
+                for(std::size_t a = 0; a < _net.actions.size(); ++a) {
+                    auto const begin = _net.transitionsBegin[a];
+                    auto const end = _net.transitionsBegin[a + 1];
+                    Index observed = 0;
+                    for(auto t = begin; t != end; ++t) {
+                        if(_net.pure[t]) {
+                            observed += _net.transitionVariablesBegin[t + 1] - _net.transitionVariablesBegin[t];
+                        }
+                    }
+                    _net.maxTransitions = std::max(_net.maxTransitions, end - begin);
+                    _net.maxObserved = std::max(_net.maxObserved, observed);
+                }
+
+                _net.observedVariables.assign(_net.variableIds.size(), false);
+                for(Index t = 0; t < _net.targets.size(); ++t) {
+                    if(_net.pure[t]) {
+                        for(auto v = _net.transitionVariablesBegin[t]; v != _net.transitionVariablesBegin[t + 1]; ++v) {
+                            _net.observedVariables[_net.transitionVariables[v]] = true;
+                        }
+                    }
+                }
+            }
+
+        private:
+            // Sorts the dispatch table of the last added action by result, and then in the order of
+            // the transitions
+            void endTransitions() {
+                if(_net.dispatchBegin.empty()) {
+                    return;
+                }
+                std::sort(_net.dispatch.begin() + _net.dispatchBegin.back(), _net.dispatch.end(), [](DispatchEntry const &e1, DispatchEntry const &e2) {
+                    return e1.result < e2.result || (e1.result == e2.result && e1.transition < e2.transition);
+                });
+            }
+
+            // The lock set of an entity is sorted by index, the global order in which the variables
+            // are always locked, so that they can be acquired one after the other without deadlock.
+            // A variable registered several times is only locked in shared mode if it is always read.
+            template <typename ForEachVariable>
+            void resolve(ForEachVariable &&forEachVariable, std::vector<Index> &variables, std::vector<LockedVariable> &locks) {
+                auto const variablesBegin = variables.size();
+                auto const locksBegin = locks.size();
+                forEachVariable([this, &variables, &locks](std::uint_fast32_t id, VariableAccess access) {
+                    auto it = _variableIndices.find(id);
+                    if(it == _variableIndices.end()) {
+                        throw std::runtime_error("Non existing variable requested: " + std::to_string(id));
+                    }
+                    variables.push_back(it->second);
+                    if(access != VariableAccess::LockFree) {
+                        locks.push_back({it->second, access == VariableAccess::Shared});
+                    }
+                });
+                std::sort(variables.begin() + variablesBegin, variables.end());
+                variables.erase(std::unique(variables.begin() + variablesBegin, variables.end()), variables.end());
+
+                std::sort(locks.begin() + locksBegin, locks.end(), [](LockedVariable const &l1, LockedVariable const &l2) {
+                    return l1.variable < l2.variable;
+                });
+                auto const first = locks.begin() + locksBegin;
+                auto out = first;
+                for(auto it = first; it != locks.end(); ++it) {
+                    if(out != first && (out - 1)->variable == it->variable) {
+                        (out - 1)->shared = (out - 1)->shared && it->shared;
+                    } else {
+                        *out++ = *it;
+                    }
+                }
+                locks.erase(out, locks.end());
+            }
+
+            FrozenNet &_net;
+            std::unordered_map<std::uint_fast32_t, Index> _variableIndices;
+        };
+
+        auto entityVariables(Entity const &entity) {
+            return [&entity](auto &&function) {
+                for(auto const &variable : entity.getVariablesWithAccess()) {
+                    function(variable.id, variable.access);
+                }
+            };
+        }
+
+        auto staticVariables(StaticNet const &net, std::uint32_t begin, std::uint32_t end) {
+            return [&net, begin, end](auto &&function) {
+                for(auto v = begin; v < end; ++v) {
+                    function(net.variables[v].id, net.variables[v].access);
+                }
+            };
+        }
+    }
+
+    thread_local PetriNet::Internals const *PetriNet::Internals::_executingNet = nullptr;
+
     PetriNet::PetriNet(std::string const &name)
             : PetriNet(std::make_unique<Internals>(*this, name)) {}
     PetriNet::PetriNet(std::unique_ptr<Internals> internals)
             : _internals(std::move(internals)) {}
+    PetriNet::PetriNet(std::shared_ptr<PetriNet> prototype)
+            : PetriNet(std::make_unique<Internals>(*this, std::move(prototype))) {}
+    PetriNet::PetriNet(std::string const &name, StaticNet const &net)
+            : PetriNet(name) {
+        _internals->freeze(net);
+    }
 
     PetriNet::~PetriNet() {
         this->stop();
@@ -46,10 +251,65 @@ namespace Petri {
         if(this->running()) {
             throw std::runtime_error("Cannot modify running petri net!");
         }
+        if(_internals->_isFrozen) {
+            throw std::runtime_error("Cannot modify frozen petri net!");
+        }
 
         _internals->_states.emplace_back(std::move(action), active);
 
-        return _internals->_states.back().first;
+        auto &added = _internals->_states.back().first;
+        added.moveTo(_internals->_arena);
+
+        return added;
+    }
+
+    void PetriNet::build(StaticNet const &net) {
+        if(this->running()) {
+            throw std::runtime_error("Cannot modify running petri net!");
+        }
+        if(_internals->_isFrozen) {
+            throw std::runtime_error("Cannot modify frozen petri net!");
+        }
+        if(!net.transitionsAreValid() || !net.variablesAreValid() || !net.functionsAreValid()) {
+            throw std::runtime_error("Invalid static petri net!");
+        }
+
+        for(std::uint32_t v = 0; v < net.netVariablesCount; ++v) {
+            this->addVariable(net.netVariables[v]);
+        }
+
+        // The transitions designate their target by its index, so the actions are all added first.
+        // They are created right into the arena of the net.
+        std::vector<Action *> actions;
+        actions.reserve(net.actionsCount);
+        for(std::uint32_t a = 0; a < net.actionsCount; ++a) {
+            auto const &action = net.actions[a];
+            _internals->_states.emplace_back(Action(action.id, action.name, make_param_action_callable(action.function),
+                                                    action.requiredTokens, _internals->_arena),
+                                             action.active);
+            actions.push_back(&_internals->_states.back().first);
+            for(auto v = action.variablesBegin; v < action.variablesEnd; ++v) {
+                actions.back()->addVariable(net.variables[v].id, net.variables[v].access);
+            }
+        }
+
+        for(std::uint32_t a = 0; a < net.actionsCount; ++a) {
+            for(auto t = net.actions[a].transitionsBegin; t < net.actions[a].transitionsEnd; ++t) {
+                auto const &transition = net.transitions[t];
+                // The name is interned right away, rather than copied into a temporary string
+                auto &added = actions[a]->addTransition(transition.id, InternedName(transition.name, std::strlen(transition.name)),
+                                                        *actions[transition.target],
+                                                        make_param_transition_callable(transition.condition));
+                added.setPure(transition.pure);
+                added.setDelayBetweenEvaluation(transition.delayBetweenEvaluation);
+                if(transition.hasExpectedResult) {
+                    added.setExpectedResult(transition.expectedResult);
+                }
+                for(auto v = transition.variablesBegin; v < transition.variablesEnd; ++v) {
+                    added.addVariable(net.variables[v].id, net.variables[v].access);
+                }
+            }
+        }
     }
 
     std::string const &PetriNet::name() const {
@@ -61,16 +321,31 @@ namespace Petri {
     }
 
     void PetriNet::addVariable(std::uint_fast32_t id) {
-        _internals->_variables.emplace(std::make_pair(id, std::make_unique<Atomic>()));
+        _internals->_variables.add(id);
     }
 
     Atomic &PetriNet::getVariable(std::uint_fast32_t id) {
-        auto it = _internals->_variables.find(id);
-        if(it == _internals->_variables.end()) {
+        auto atomic = _internals->_variables.find(id);
+        if(atomic == nullptr) {
             throw std::runtime_error("Non existing variable requested: " + std::to_string(id));
         }
 
-        return *it->second;
+        return *atomic;
+    }
+
+    void PetriNet::freeze() {
+        if(!_internals->_isFrozen) {
+            _internals->freeze();
+            _internals->_isFrozen = true;
+        }
+    }
+
+    std::size_t PetriNet::chainDepth() const {
+        return _internals->_chainDepth;
+    }
+
+    void PetriNet::setChainDepth(std::size_t depth) {
+        _internals->_chainDepth = depth;
     }
 
     void PetriNet::run() {
@@ -78,161 +353,712 @@ namespace Petri {
             throw std::runtime_error("Already running!");
         }
 
-        for(auto &p : _internals->_states) {
-            if(p.second) {
-                _internals->_running = true;
-                _internals->enableState(p.first);
-            }
+        this->freeze();
+
+        // The states of the previous run may still be ending if it was stopped by one of them
+        _internals->drain();
+
+        if(_internals->_frozen->initialActions.empty()) {
+            return;
+        }
+
+        // The worker threads are all spawned up front, none is ever created while the net runs
+        _internals->_actionsPool->start(_internals->workerCount());
+
+        // The initial states are all counted before any of them is enabled, so that the first ones
+        // ending in the meantime do not end the execution.
+        _internals->_running = true;
+        _internals->_liveStates += _internals->_frozen->initialActions.size();
+        for(auto a : _internals->_frozen->initialActions) {
+            _internals->startState(a);
         }
     }
 
     void PetriNet::stop() {
         if(this->running()) {
-            _internals->_running = false;
+            {
+                // Under the mutex, so that a thread about to wait in join() can not miss it
+                std::lock_guard<std::mutex> lk(_internals->_activationMutex);
+                _internals->_running = false;
+            }
             _internals->_activationCondition.notify_all();
+            _internals->wakeActiveStates();
+        }
+
+        // The worker threads are kept for the next run. When stopped from one of its own actions,
+        // the net can not wait for the calling state, and is drained when stopped again by its
+        // owner. Being on one of its workers is not enough to know it, as other instances may share
+        // them.
+        if(Internals::_executingNet != _internals.get()) {
+            _internals->drain();
+        }
+    }
+
+    void PetriNet::reset() {
+        if(this->running()) {
+            throw std::runtime_error("Cannot reset running petri net!");
+        }
+
+        _internals->drain();
+        this->freeze();
+
+        for(auto tokens : _internals->_tokens) {
+            *tokens = 0;
+        }
+        for(std::size_t v = 0; v < _internals->_frozenVariables.size(); ++v) {
+            _internals->_frozenVariables[v]->store(_internals->_frozen->initialValues[v]);
         }
-        _internals->_actionsPool.stop();
     }
 
     void PetriNet::join() {
-        // Quick and dirty…
-        while(this->running()) {
-            std::this_thread::sleep_for(std::chrono::nanoseconds(1'000'000));
+        std::unique_lock<std::mutex> lk(_internals->_activationMutex);
+        _internals->_activationCondition.wait(lk, [this]() { return !this->running(); });
+    }
+
+    bool PetriNet::joinFor(std::chrono::nanoseconds timeout) {
+        std::unique_lock<std::mutex> lk(_internals->_activationMutex);
+        return _internals->_activationCondition.wait_for(lk, timeout, [this]() { return !this->running(); });
+    }
+
+    PetriNet::Internals::Internals(PetriNet &pn, std::shared_ptr<PetriNet> prototype)
+            : _actionsPool(prototype->_internals->_actionsPool)
+            , _chainDepth(prototype->chainDepth())
+            , _name(prototype->name())
+            , _frozen(prototype->_internals->_frozen)
+            , _isFrozen(true)
+            , _prototype(std::move(prototype))
+            , _this(pn) {
+        this->bindFrozenNet();
+    }
+
+    std::size_t PetriNet::Internals::workerCount() const {
+        // As many workers as the states which can run in parallel, up to about one per core, but
+        // at least 2 when there are several of them so that an action blocking its worker (such as
+        // Utility::pause) does not stall the whole net on a single core machine.
+        if(_frozen->parallelism <= 1) {
+            return 1;
         }
+        return std::min<std::size_t>(_frozen->parallelism, std::max(2u, std::thread::hardware_concurrency()));
     }
 
-    void PetriNet::Internals::executeState(Action &state) {
-        Action *nextState = nullptr;
+    void PetriNet::Internals::freeze() {
+        auto frozen = std::make_shared<FrozenNet>();
+        FrozenNetBuilder builder(*frozen, _variables);
 
-        actionResult_t res;
+        std::unordered_map<Action const *, FrozenNet::Index> indices;
+        for(auto &p : _states) {
+            indices.emplace(&p.first, static_cast<FrozenNet::Index>(indices.size()));
+        }
 
-        {
-            std::vector<std::unique_lock<std::mutex>> locks;
-            locks.reserve(state.getVariables().size());
-            for(auto &var : state.getVariables()) {
-                locks.emplace_back(_this.getVariable(var).getLock());
+        // The transitions of an action are numbered contiguously, in the order they are evaluated.
+        for(auto &p : _states) {
+            Action &a = p.first;
+            builder.addAction(&a, a.action(), a.requiredTokens(), p.second, entityVariables(a));
+
+            for(auto &transition : a.transitions()) {
+                auto &t = const_cast<Transition &>(transition);
+                auto it = indices.find(&t.next());
+                if(it == indices.end()) {
+                    throw std::runtime_error("The transition " + t.name() +
+                                             " leads to an action which is not part of the petri net!");
+                }
+
+                builder.addTransition(t.condition(),
+                                      it->second,
+                                      t.isPure(),
+                                      t.delayBetweenEvaluation(),
+                                      t.hasExpectedResult(),
+                                      t.expectedResult(),
+                                      entityVariables(t));
             }
+        }
+        builder.finish();
 
-            lock(locks.begin(), locks.end());
+        frozen->parallelism = structuralParallelism(*frozen);
 
-            // Runs the Callable
-            res = state.action()(_this);
+        _frozen = std::move(frozen);
+        this->bindFrozenNet();
+    }
+
+    void PetriNet::Internals::freeze(StaticNet const &net) {
+        for(std::uint32_t v = 0; v < net.netVariablesCount; ++v) {
+            _variables.add(net.netVariables[v]);
         }
 
-        if(!state.transitions().empty()) {
-            std::list<Transition *> transitionsToTest;
-            for(auto &t : state.transitions()) {
-                transitionsToTest.push_back(const_cast<Transition *>(&t));
+        auto frozen = std::make_shared<FrozenNet>();
+        frozen->isStatic = true;
+
+        // Reserved up front, as the callables and conditions point into them
+        frozen->staticCallables.reserve(net.actionsCount);
+        frozen->staticConditions.reserve(net.transitionsCount);
+        frozen->actions.reserve(net.actionsCount);
+        frozen->conditions.reserve(net.transitionsCount);
+
+        FrozenNetBuilder builder(*frozen, _variables);
+        for(std::uint32_t a = 0; a < net.actionsCount; ++a) {
+            auto const &action = net.actions[a];
+            frozen->staticCallables.emplace_back(action.function);
+            builder.addAction(nullptr,
+                              frozen->staticCallables.back(),
+                              action.requiredTokens,
+                              action.active,
+                              staticVariables(net, action.variablesBegin, action.variablesEnd));
+
+            for(auto t = action.transitionsBegin; t < action.transitionsEnd; ++t) {
+                auto const &transition = net.transitions[t];
+                frozen->staticConditions.emplace_back(transition.condition);
+                builder.addTransition(frozen->staticConditions.back(),
+                                      transition.target,
+                                      transition.pure,
+                                      transition.delayBetweenEvaluation,
+                                      transition.hasExpectedResult,
+                                      transition.expectedResult,
+                                      staticVariables(net, transition.variablesBegin, transition.variablesEnd));
             }
+        }
+        builder.finish();
+
+        frozen->parallelism = structuralParallelism(*frozen);
 
-            auto lastTest = ClockType::time_point();
+        _frozen = std::move(frozen);
+        _isFrozen = true;
+        this->bindFrozenNet();
+    }
 
-            while(_running && transitionsToTest.size()) {
-                auto now = ClockType::now();
-                auto minDelay = ClockType::duration::max() / 2;
+    void PetriNet::Internals::bindFrozenNet() {
+        FrozenNet const &net = *_frozen;
 
-                for(auto it = transitionsToTest.begin(); it != transitionsToTest.end();) {
-                    bool isFulfilled = false;
+        // An instance gets its own counters and variables, starting from the values the variables
+        // of its prototype had when it was frozen. A static net has no Action to hold its counters.
+        if(_prototype || net.isStatic) {
+            _counters.reset(new std::atomic_size_t[2 * net.actions.size()]);
+            for(std::size_t i = 0; i < 2 * net.actions.size(); ++i) {
+                _counters[i] = 0;
+            }
+        }
+        if(_prototype) {
+            for(std::size_t v = 0; v < net.variableIds.size(); ++v) {
+                _variables.add(net.variableIds[v]).store(net.initialValues[v]);
+            }
+        }
 
-                    if((now - lastTest) >= (*it)->delayBetweenEvaluation()) {
-                        {
-                            std::vector<std::unique_lock<std::mutex>> locks;
-                            locks.reserve((*it)->getVariables().size());
-                            for(auto &var : (*it)->getVariables()) {
-                                locks.emplace_back(_this.getVariable(var).getLock());
-                            }
+        _tokens.clear();
+        _activations.clear();
+        for(std::size_t a = 0; a < net.actions.size(); ++a) {
+            if(_counters) {
+                _tokens.push_back(&_counters[2 * a]);
+                _activations.push_back(&_counters[2 * a + 1]);
+            } else {
+                _tokens.push_back(&net.actions[a]->currentTokensRef());
+                _activations.push_back(&net.actions[a]->activationsRef());
+            }
+        }
 
-                            lock(locks.begin(), locks.end());
+        _frozenVariables.clear();
+        for(auto id : net.variableIds) {
+            _frozenVariables.push_back(_variables.find(id));
+        }
 
-                            // Testing the transition
-                            isFulfilled = (*it)->isFulfilled(_this, res);
-                        }
+        // The records of the states which can be active at the same time, so that the net does not
+        // allocate any of them while it runs
+        this->createRecords(static_cast<std::uint32_t>(net.parallelism));
+        for(auto index = _recordsCount; index-- > 0;) {
+            this->releaseRecord(this->record(index));
+        }
+    }
 
-                        minDelay = std::min(minDelay, (*it)->delayBetweenEvaluation());
-                    } else {
-                        minDelay = std::min(minDelay, (*it)->delayBetweenEvaluation() - (now - lastTest));
-                    }
+    std::size_t PetriNet::Internals::structuralParallelism(FrozenNet const &net) {
+        using Index = FrozenNet::Index;
 
-                    if(isFulfilled) {
-                        Action &a = (*it)->next();
-                        std::lock_guard<std::mutex> tokensLock(a.tokensMutex());
-                        if(++a.currentTokensRef() >= a.requiredTokens()) {
-                            a.currentTokensRef() -= a.requiredTokens();
-
-                            if(nextState == nullptr) {
-                                nextState = &a;
-                            } else {
-                                this->enableState(a);
-                            }
-                        }
+        // The loops are broken by dropping the back edges of a depth-first search from the initial
+        // actions, which also gives a topological order of the remaining graph.
+        enum : std::uint8_t { Unvisited, Visiting, Done };
+        std::vector<std::uint8_t> visit(net.actions.size(), Unvisited);
+        std::vector<std::uint8_t> backEdge(net.targets.size(), false);
+        std::vector<Index> order;
+        std::vector<std::pair<Index, Index>> stack;
+        for(auto initial : net.initialActions) {
+            if(visit[initial] != Unvisited) {
+                continue;
+            }
+            visit[initial] = Visiting;
+            stack.emplace_back(initial, net.transitionsBegin[initial]);
+            while(!stack.empty()) {
+                auto &top = stack.back();
+                if(top.second == net.transitionsBegin[top.first + 1]) {
+                    visit[top.first] = Done;
+                    order.push_back(top.first);
+                    stack.pop_back();
+                    continue;
+                }
 
-                        it = transitionsToTest.erase(it);
+                auto const t = top.second++;
+                auto const target = net.targets[t];
+                if(visit[target] == Visiting) {
+                    backEdge[t] = true;
+                } else if(visit[target] == Unvisited) {
+                    visit[target] = Visiting;
+                    stack.emplace_back(target, net.transitionsBegin[target]);
+                }
+            }
+        }
+        std::reverse(order.begin(), order.end());
+
+        // Each initial action brings a token, which is passed on by all of the transitions of an
+        // action, as they may all be fulfilled, and merged by the joins. The actions are grouped by
+        // their longest distance from the initial ones, and the states of a group may all be active
+        // at the same time.
+        std::vector<double> tokens(net.actions.size(), 0);
+        std::vector<std::size_t> depth(net.actions.size(), 0);
+        for(auto initial : net.initialActions) {
+            tokens[initial] += 1;
+        }
+        std::vector<double> parallelism;
+        for(auto a : order) {
+            if(depth[a] >= parallelism.size()) {
+                parallelism.resize(depth[a] + 1, 0);
+            }
+            parallelism[depth[a]] += tokens[a];
+
+            for(auto t = net.transitionsBegin[a]; t != net.transitionsBegin[a + 1]; ++t) {
+                if(!backEdge[t]) {
+                    auto const target = net.targets[t];
+                    tokens[target] += tokens[a] / std::max<std::size_t>(net.requiredTokens[target], 1);
+                    depth[target] = std::max(depth[target], depth[a] + 1);
+                }
+            }
+        }
+
+        double max = 1;
+        for(auto p : parallelism) {
+            max = std::max(max, p);
+        }
+        return static_cast<std::size_t>(std::ceil(max));
+    }
+
+    bool PetriNet::Internals::executeState(ActiveState &activeState) {
+        // The states enabled before the net was stopped are dropped
+        if(!_running) {
+            this->disableState(activeState);
+            return false;
+        }
+
+        FrozenNet const &net = *_frozen;
+        auto const state = activeState._state;
+        auto const variablesBegin = net.actionVariables.data() + net.actionVariablesBegin[state];
+        auto const variablesEnd = net.actionVariables.data() + net.actionVariablesBegin[state + 1];
+        activeState._executed = true;
+
+        {
+            VariablesLock lock(_frozenVariables.data(),
+                               net.actionLocks.data() + net.actionLocksBegin[state],
+                               net.actionLocks.data() + net.actionLocksBegin[state + 1]);
+
+            // Runs the Callable
+            activeState._result = (*net.callables[state])(_this);
+        }
+
+        // The action may have changed its variables, so the transitions depending on them have to
+        // be woken up.
+        for(auto it = variablesBegin; it != variablesEnd; ++it) {
+            _frozenVariables[*it]->notifyChange();
+        }
+
+        if(net.transitionsBegin[state] == net.transitionsBegin[state + 1]) {
+            this->disableState(activeState);
+            return false;
+        }
+
+        this->observeTransitions(activeState);
+        return this->evaluateTransitions(activeState);
+    }
+
+    bool PetriNet::Internals::evaluateTransitions(ActiveState &state) {
+        TimerWheel::instance().cancel(state);
+
+        FrozenNet const &net = *_frozen;
+        FrozenNet::Index nextState = 0;
+        bool hasNextState = false;
+        // Whether other states than nextState have been enabled by the transitions
+        bool forked = false;
+
+        while(_running && !state._transitionsToTest.empty()) {
+            auto now = ClockType::now();
+            auto minDelay = ClockType::duration::max() / 2;
+            bool polling = false;
+
+            for(auto it = state._transitionsToTest.begin(); it != state._transitionsToTest.end();) {
+                auto const t = *it;
+                bool isFulfilled = false;
+                bool evaluate;
+
+                if(net.dispatched[t]) {
+                    // Found in the dispatch table, so its condition is known to be fulfilled
+                    isFulfilled = true;
+                    evaluate = false;
+                } else if(net.pure[t]) {
+                    // A pure transition is only evaluated again when one of its variables has been
+                    // modified. As the versions only grow, their sum changes as soon as one of them
+                    // does. It is read before the evaluation, so that no modification can be missed.
+                    std::uint64_t version = 0;
+                    for(auto v = net.transitionVariablesBegin[t]; v != net.transitionVariablesBegin[t + 1]; ++v) {
+                        version += _frozenVariables[net.transitionVariables[v]]->version();
+                    }
+
+                    auto &lastVersion = state._versions[t - net.transitionsBegin[state._state]];
+                    evaluate = state._firstTest || version != lastVersion;
+                    lastVersion = version;
+                } else {
+                    polling = true;
+                    evaluate = (now - state._lastTest) >= net.delays[t];
+                    if(evaluate) {
+                        minDelay = std::min<ClockType::duration>(minDelay, net.delays[t]);
                     } else {
-                        ++it;
+                        minDelay = std::min<ClockType::duration>(minDelay, net.delays[t] - (now - state._lastTest));
                     }
                 }
 
-                if(nextState != nullptr) {
-                    break;
-                } else {
-                    lastTest = now;
+                if(evaluate) {
+                    VariablesLock lock(_frozenVariables.data(),
+                                       net.transitionLocks.data() + net.transitionLocksBegin[t],
+                                       net.transitionLocks.data() + net.transitionLocksBegin[t + 1]);
+
+                    // Testing the transition
+                    isFulfilled = (*net.conditions[t])(_this, state._result);
+                }
 
-                    while(ClockType::now() - lastTest <= minDelay) {
-                        std::this_thread::sleep_for(std::min(1000000ns, minDelay));
+                if(isFulfilled) {
+                    auto const a = net.targets[t];
+                    if(this->addToken(a)) {
+                        if(!hasNextState) {
+                            nextState = a;
+                            hasNextState = true;
+                        } else {
+                            forked = true;
+                            this->enableState(a);
+                        }
                     }
+
+                    it = state._transitionsToTest.erase(it);
+                } else if(evaluate && net.resultOnly[t]) {
+                    // Its answer can not change anymore, so it does not have to be waited for.
+                    it = state._transitionsToTest.erase(it);
+                } else {
+                    ++it;
                 }
             }
+
+            state._firstTest = false;
+
+            // Either a transition is fulfilled, or all of them have been crossed without enabling
+            // any state, as their next states still lack some tokens.
+            if(hasNextState || state._transitionsToTest.empty()) {
+                break;
+            }
+
+            if(polling) {
+                state._lastTest = now;
+                TimerWheel::instance().schedule(state, now + minDelay);
+            }
+
+            // Parks the state until a variable a pure transition depends on changes, or until the
+            // next polled transition is due, or until the net is stopped. It must not be accessed
+            // anymore once parked, as another worker may already be evaluating it.
+            int status = ActiveState::Evaluating;
+            if(state._status.compare_exchange_strong(status, ActiveState::Waiting)) {
+                return false;
+            }
+
+            // Woken up during the evaluation
+            state._status = ActiveState::Evaluating;
+            TimerWheel::instance().cancel(state);
         }
 
-        if(nextState != nullptr) {
-            this->swapStates(state, *nextState);
-        } else {
-            this->disableState(state);
+        this->stopWaiting(state);
+
+        if(hasNextState) {
+            return this->swapStates(state, nextState, forked);
         }
+
+        this->disableState(state);
+        return false;
     }
 
-    void PetriNet::Internals::swapStates(Action &oldAction, Action &newAction) {
-        {
-            std::lock_guard<std::mutex> lk(_activationMutex);
-            _activeStates.insert(&newAction);
+    void PetriNet::Internals::ActiveState::activate(FrozenNet::Index state) {
+        _state = state;
+        _executed = false;
+        _firstTest = true;
+        _lastTest = ClockType::time_point();
+        _status = Scheduled;
+    }
 
-            auto it = _activeStates.find(&oldAction);
-            assert(it != _activeStates.end());
-            _activeStates.erase(it);
-        }
+    void PetriNet::Internals::ActiveState::runTask() {
+        // A net stopped from there is only left undrained when it is this one
+        auto previousNet = _executingNet;
+        _executingNet = &_internals;
 
-        this->stateDisabled(oldAction);
-        this->stateEnabled(newAction);
+        // The next states are executed right away on this worker, as long as swapStates() chains
+        // them.
+        _chained = 0;
+        bool chained;
+        do {
+            _status = Evaluating;
+            if(_executed) {
+                chained = _internals.evaluateTransitions(*this);
+            } else {
+                chained = _internals.executeState(*this);
+            }
+        } while(chained);
 
-        _actionsPool.addTask(make_callable([this, &newAction]() { this->executeState(newAction); }));
+        _executingNet = previousNet;
     }
 
-    void PetriNet::Internals::enableState(Action &a) {
-        {
-            std::lock_guard<std::mutex> lk(_activationMutex);
-            _activeStates.insert(&a);
+    void PetriNet::Internals::ActiveState::atomicChanged() {
+        this->wake();
+    }
+
+    void PetriNet::Internals::ActiveState::timerExpired() {
+        this->wake();
+    }
 
-            if(_actionsPool.threadCount() < _activeStates.size()) {
-                _actionsPool.addThread();
+    void PetriNet::Internals::ActiveState::wake() {
+        int status = _status;
+        while(true) {
+            if(status == Waiting) {
+                if(_status.compare_exchange_weak(status, Scheduled)) {
+                    // Not a successor of the task which woke it up, if any: an idle worker may run it
+                    // right away, rather than after the states chained by the current worker.
+                    _internals._actionsPool->forkTask(*this);
+                    return;
+                }
+            } else if(status == Evaluating) {
+                if(_status.compare_exchange_weak(status, EvaluatingWoken)) {
+                    return;
+                }
+            } else {
+                // Already going to be evaluated again
+                return;
             }
         }
+    }
 
-        this->stateEnabled(a);
-        _actionsPool.addTask(make_callable([this, &a]() { this->executeState(a); }));
+    bool PetriNet::Internals::addToken(FrozenNet::Index a) {
+        // The token and, once there are enough of them, their consumption are a single atomic
+        // update, so that the branches converging on a join never wait for each other.
+        auto &tokens = *_tokens[a];
+        auto const required = _frozen->requiredTokens[a];
+        std::size_t current = tokens.load();
+        bool enabled;
+        do {
+            enabled = current + 1 >= required;
+        } while(!tokens.compare_exchange_weak(current, enabled ? current + 1 - required : current + 1));
+
+        return enabled;
     }
 
-    void PetriNet::Internals::disableState(Action &a) {
-        std::lock_guard<std::mutex> lk(_activationMutex);
+    bool PetriNet::Internals::swapStates(ActiveState &state, FrozenNet::Index newAction, bool forked) {
+        --*_activations[state._state];
+        ++*_activations[newAction];
+        this->stateDisabled(state._state);
+        this->stateEnabled(newAction);
+
+        // The record goes on with the next state, either on the current worker or through the
+        // thread pool. It must not be accessed anymore once added to the thread pool. A single
+        // next state is chained, unless the pool has been paused, e.g. by a breakpoint set when
+        // the state was enabled. The branches of a fork are all left to the pool, so that they
+        // run concurrently, and so is the next state when a task is already waiting for this
+        // worker, which runs first instead of waiting for the whole chain.
+        state.activate(newAction);
+        if(forked || _actionsPool->hasLocalTask()) {
+            _actionsPool->forkTask(state);
+            return false;
+        }
+        if(_running && !_actionsPool->paused() && state._chained < _chainDepth) {
+            ++state._chained;
+            return true;
+        }
+
+        _actionsPool->addTask(state);
+        return false;
+    }
+
+    void PetriNet::Internals::enableState(FrozenNet::Index a) {
+        ++_liveStates;
+        this->startState(a);
+    }
 
-        auto it = _activeStates.find(&a);
-        assert(it != _activeStates.end());
+    void PetriNet::Internals::startState(FrozenNet::Index a) {
+        ++*_activations[a];
 
-        _activeStates.erase(it);
+        ActiveState &state = this->acquireRecord();
+        state.activate(a);
+
+        this->stateEnabled(a);
+        _actionsPool->forkTask(state);
+    }
+
+    void PetriNet::Internals::disableState(ActiveState &state) {
+        auto const a = state._state;
+        --*_activations[a];
+
+        // The record may be reused by another thread as soon as it is released
+        this->releaseRecord(state);
 
         this->stateDisabled(a);
-        if(_activeStates.size() == 0 && _running) {
+        this->liveStateEnded();
+    }
+
+    void PetriNet::Internals::liveStateEnded() {
+        auto live = _liveStates.load();
+        while(live > 1) {
+            if(_liveStates.compare_exchange_weak(live, live - 1)) {
+                return;
+            }
+        }
+
+        // The last live state, so no other state can be enabled until the execution is over. It is
+        // only counted out under the mutex, after which the net is not accessed anymore as
+        // drain() may return and the net be destroyed.
+        if(_running) {
             std::cout << "End of execution." << std::endl;
             _this.stop();
         }
+
+        std::lock_guard<std::mutex> lk(_activationMutex);
+        --_liveStates;
+        _activationCondition.notify_all();
+    }
+
+    void PetriNet::Internals::drain() {
+        // A paused pool would never run the remaining states
+        _actionsPool->resume();
+
+        std::unique_lock<std::mutex> lk(_activationMutex);
+        _activationCondition.wait(lk, [this]() { return _liveStates == 0; });
+    }
+
+    PetriNet::Internals::ActiveState &PetriNet::Internals::acquireRecord() {
+        auto head = _freeRecords.load(std::memory_order_acquire);
+        while(static_cast<std::uint32_t>(head) != NoRecord) {
+            ActiveState &top = this->record(static_cast<std::uint32_t>(head));
+            auto const next = ((head >> 32) + 1) << 32 | top._nextFree.load(std::memory_order_relaxed);
+            if(_freeRecords.compare_exchange_weak(head, next, std::memory_order_acquire)) {
+                return top;
+            }
+        }
+
+        // More states are active than the net was estimated to allow. The records are doubled at
+        // once, so that it does not happen again at each new state.
+        std::lock_guard<std::mutex> lk(_activationMutex);
+        auto const first = _recordsCount;
+        this->createRecords(2 * _recordsCount);
+        for(auto index = _recordsCount; --index > first;) {
+            this->releaseRecord(this->record(index));
+        }
+
+        return this->record(first);
+    }
+
+    void PetriNet::Internals::createRecords(std::uint32_t count) {
+        count = std::max(count, 1u);
+        while(_recordsCount < count) {
+            _records.emplace_back(*this);
+            ActiveState &created = _records.back();
+            created._index = _recordsCount++;
+
+            // Large enough for any state of the net, so that the record never allocates once created
+            created._transitionsToTest.reserve(_frozen->maxTransitions);
+            created._versions.reserve(_frozen->maxTransitions);
+            created._observed.reserve(_frozen->maxObserved);
+
+            std::uint32_t block = 0;
+            for(auto j = (created._index >> 6) + 1; j >>= 1;) {
+                ++block;
+            }
+            if(_recordsIndex[block] == nullptr) {
+                _recordsIndex[block] = std::make_unique<ActiveState *[]>(std::size_t(64) << block);
+            }
+            _recordsIndex[block][created._index - ((64u << block) - 64)] = &created;
+        }
+
+        for(std::size_t v = 0; v < _frozenVariables.size(); ++v) {
+            if(_frozen->observedVariables[v]) {
+                _frozenVariables[v]->reserveObservers(_recordsCount);
+            }
+        }
+    }
+
+    void PetriNet::Internals::releaseRecord(ActiveState &record) {
+        auto head = _freeRecords.load(std::memory_order_relaxed);
+        std::uint64_t next;
+        do {
+            record._nextFree.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed);
+            next = ((head >> 32) + 1) << 32 | record._index;
+        } while(!_freeRecords.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    PetriNet::Internals::ActiveState &PetriNet::Internals::record(std::uint32_t index) {
+        // Block k holds the records [64 * (2^k - 1), 64 * (2^(k + 1) - 1))
+        std::uint32_t block = 0;
+        for(auto j = (index >> 6) + 1; j >>= 1;) {
+            ++block;
+        }
+        return *_recordsIndex[block][index - ((64u << block) - 64)];
+    }
+
+    void PetriNet::Internals::observeTransitions(ActiveState &state) {
+        FrozenNet const &net = *_frozen;
+
+        // The transitions comparing the result with a constant are looked up in the dispatch table,
+        // so that only the fulfilled ones are tested, without calling any of their conditions.
+        auto const dispatch = std::equal_range(net.dispatch.begin() + net.dispatchBegin[state._state],
+                                               net.dispatch.begin() + net.dispatchBegin[state._state + 1],
+                                               DispatchEntry{state._result, 0},
+                                               [](DispatchEntry const &e1, DispatchEntry const &e2) {
+                                                   return e1.result < e2.result;
+                                               });
+        for(auto it = dispatch.first; it != dispatch.second; ++it) {
+            state._transitionsToTest.push_back(it->transition);
+        }
+        for(auto t = net.transitionsBegin[state._state]; t != net.transitionsBegin[state._state + 1]; ++t) {
+            if(!net.dispatched[t]) {
+                state._transitionsToTest.push_back(t);
+            }
+        }
+        state._versions.assign(net.transitionsBegin[state._state + 1] - net.transitionsBegin[state._state], 0);
+
+        // The pure transitions are only evaluated once, and then each time one of their variables
+        // changes. The state observes them before its first evaluation so that no change can be
+        // missed.
+        for(auto t : state._transitionsToTest) {
+            if(net.pure[t]) {
+                for(auto v = net.transitionVariablesBegin[t]; v != net.transitionVariablesBegin[t + 1]; ++v) {
+                    Atomic *atomic = _frozenVariables[net.transitionVariables[v]];
+                    if(std::find(state._observed.begin(), state._observed.end(), atomic) == state._observed.end()) {
+                        state._observed.push_back(atomic);
+                        atomic->addObserver(state);
+                    }
+                }
+            }
+        }
+    }
+
+    void PetriNet::Internals::stopWaiting(ActiveState &state) {
+        // Once the state is not known to the timer wheel and the variables anymore, only stop() can
+        // wake it up concurrently.
+        TimerWheel::instance().cancel(state);
+        for(auto atomic : state._observed) {
+            atomic->removeObserver(state);
+        }
+        state._observed.clear();
+        state._transitionsToTest.clear();
+    }
+
+    void PetriNet::Internals::wakeActiveStates() {
+        // Only the parked records are added to the thread pool, and they are all active
+        std::lock_guard<std::mutex> lk(_activationMutex);
+        for(auto &state : _records) {
+            state.wake();
+        }
     }
 }
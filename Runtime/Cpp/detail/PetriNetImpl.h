@@ -31,59 +31,358 @@
 #define IA_Pe_tri_PetriImp_h
 
 #include "../Action.h"
+#include "../Arena.h"
 #include "../Atomic.h"
 #include "../Common.h"
+#include "../StaticPetriNet.h"
 #include "../Transition.h"
-#include "ThreadPool.h"
+#include "WorkStealingThreadPool.h"
+#include "TimerWheel.h"
+#include "VariableTable.h"
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <deque>
 #include <list>
-#include <map>
 #include <mutex>
 #include <queue>
 #include <set>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 namespace Petri {
-    enum { InitialThreadsActions = 1 };
     using ClockType =
     std::conditional<std::chrono::high_resolution_clock::is_steady, std::chrono::high_resolution_clock, std::chrono::steady_clock>::type;
 
+    /**
+     * A variable of the lock set of an action or a transition.
+     */
+    struct LockedVariable {
+        // The index of the variable in FrozenNet::variableIds
+        std::uint32_t variable;
+        // Whether the variable is only read, and thus locked in shared mode
+        bool shared;
+    };
+
+    /**
+     * An entry of the dispatch table of an action, mapping a result of the action to one of its
+     * transitions which is fulfilled by this result.
+     */
+    struct DispatchEntry {
+        actionResult_t result;
+        std::uint32_t transition;
+    };
+
+    /**
+     * The compact form of a petri net, into which it is lowered by PetriNet::freeze(). The actions
+     * and transitions are designated by their index in contiguous arrays, the outgoing transitions
+     * of an action being sorted by source action so that they form a range of the transitions
+     * arrays. The predecessors and variables of the entities are stored the same way, as the
+     * ranges [begin[i], begin[i + 1]) of flat arrays. The execution only works on this form, so
+     * that it does not have to walk the lists and the pimpls of the entities.
+     * It is immutable once built, and shared by all of the instances of a PetriNetPrototype: the
+     * marking of the net and its variables are owned by each instance, the variables being
+     * designated by their index in variableIds.
+     * A net built from the tables of a StaticNet has no Action nor Transition: its actions are
+     * null, and it owns the callables of its actions and transitions.
+     */
+    struct FrozenNet {
+        using Index = std::uint32_t;
+
+        // Indexed by action
+        std::vector<Action *> actions;
+        std::vector<ParametrizedActionCallable const *> callables;
+        std::vector<std::size_t> requiredTokens;
+        std::vector<Index> transitionsBegin;
+        std::vector<Index> predecessorsBegin;
+        std::vector<Index> actionVariablesBegin;
+        std::vector<Index> actionLocksBegin;
+        std::vector<Index> dispatchBegin;
+
+        // The transitions leading to each action
+        std::vector<Index> predecessors;
+        // The variables of each action, notified after its execution
+        std::vector<Index> actionVariables;
+        // The variables locked during the execution of each action, sorted by index
+        std::vector<LockedVariable> actionLocks;
+        // The transitions of each action which have an expected result, sorted by result
+        std::vector<DispatchEntry> dispatch;
+        // The actions which are active when the net is started
+        std::vector<Index> initialActions;
+        // The estimated maximum number of states which can be active at the same time
+        std::size_t parallelism = 1;
+        // The largest number of transitions of an action, and of variables of the pure transitions
+        // of an action, so that the records of the states never grow once created
+        Index maxTransitions = 0;
+        Index maxObserved = 0;
+
+        // Indexed by variable, in the order of their ids
+        std::vector<std::uint_fast32_t> variableIds;
+        // The values of the variables when the net was frozen, restored by PetriNet::reset()
+        std::vector<std::int64_t> initialValues;
+        // Whether each variable is observed by a pure transition, and thus by the waiting states
+        std::vector<std::uint8_t> observedVariables;
+
+        // Indexed by transition
+        std::vector<ParametrizedTransitionCallable const *> conditions;
+        std::vector<Index> targets;
+        std::vector<std::uint8_t> pure;
+        // Pure and without any variable: the condition only depends on the result of the action
+        std::vector<std::uint8_t> resultOnly;
+        // Only tested when found in the dispatch table, and then fulfilled without evaluation
+        std::vector<std::uint8_t> dispatched;
+        std::vector<std::chrono::nanoseconds> delays;
+        std::vector<Index> transitionVariablesBegin;
+        std::vector<Index> transitionLocksBegin;
+
+        // The variables of each transition, observed when it is pure
+        std::vector<Index> transitionVariables;
+        // The variables locked during the evaluation of each transition, sorted by index
+        std::vector<LockedVariable> transitionLocks;
+
+        // Whether the net has been built from a StaticNet, and the callables it then owns
+        bool isStatic = false;
+        std::vector<ParametrizedActionCallable> staticCallables;
+        std::vector<ParametrizedTransitionCallable> staticConditions;
+    };
+
+    /**
+     * Locks the lock set of an action or a transition for the duration of its scope. The lock sets
+     * are sorted by the index of their variables when the net is frozen, which is the same global
+     * order for all of them, so the variables are simply acquired one after the other, without any
+     * risk of deadlock nor any retry. The variables which are only read are locked in shared mode.
+     */
+    class VariablesLock {
+    public:
+        VariablesLock(Atomic *const *variables, LockedVariable const *begin, LockedVariable const *end)
+                : _variables(variables)
+                , _begin(begin)
+                , _end(end) {
+            for(auto it = _begin; it != _end; ++it) {
+                if(it->shared) {
+                    _variables[it->variable]->getMutex().lock_shared();
+                } else {
+                    _variables[it->variable]->getMutex().lock();
+                }
+            }
+        }
+
+        ~VariablesLock() {
+            for(auto it = _end; it != _begin;) {
+                --it;
+                if(it->shared) {
+                    _variables[it->variable]->getMutex().unlock_shared();
+                } else {
+                    _variables[it->variable]->getMutex().unlock();
+                }
+            }
+        }
+
+        VariablesLock(VariablesLock const &) = delete;
+        VariablesLock &operator=(VariablesLock const &) = delete;
+
+    private:
+        Atomic *const *const _variables;
+        LockedVariable const *const _begin;
+        LockedVariable const *const _end;
+    };
+
     struct PetriNet::Internals {
+        struct ActiveState;
 
         Internals(PetriNet &pn, std::string const &name)
-                : _actionsPool(InitialThreadsActions, name.empty() ? "Anonymous PetriNet" : name)
+                : _actionsPool(std::make_shared<WorkStealingThreadPool<void>>(name.empty() ? "Anonymous PetriNet" : name))
                 , _name(name.empty() ? "Anonymous PetriNet" : name)
                 , _this(pn) {}
-        virtual ~Internals() {}
 
-        // This method is executed concurrently on the thread pool.
-        virtual void executeState(Action &a);
+        // Creates an instance of a frozen net, which shares its frozen form and its worker threads
+        Internals(PetriNet &pn, std::shared_ptr<PetriNet> prototype);
+
+        virtual ~Internals() {
+            if(!_prototype) {
+                _actionsPool->stop();
+            }
+        }
+
+        // The worker threads count of the actions pool, which does not depend on the number of
+        // active states as the waiting ones do not occupy any worker.
+        std::size_t workerCount() const;
+
+        // Estimates the maximum number of states of the frozen net which can be active at the
+        // same time, from its graph
+        static std::size_t structuralParallelism(FrozenNet const &net);
+
+        // This method is executed concurrently on the thread pool. Returns whether the state has
+        // been swapped for the next one, which is to be executed right away by the caller.
+        virtual bool executeState(ActiveState &state);
+
+        virtual void stateEnabled(FrozenNet::Index) {}
+        virtual void stateDisabled(FrozenNet::Index) {}
+
+        // Lowers the actions and transitions into _frozen
+        void freeze();
 
-        virtual void stateEnabled(Action &) {}
-        virtual void stateDisabled(Action &) {}
+        // Lowers the tables of a static net into _frozen
+        void freeze(StaticNet const &net);
 
-        void enableState(Action &a);
-        void disableState(Action &a);
-        void swapStates(Action &oldAction, Action &newAction);
+        // Binds the marking and the variables of this net to the indices of _frozen
+        void bindFrozenNet();
 
+        // Gives a token to an action, and returns whether it has enough of them to be enabled
+        bool addToken(FrozenNet::Index a);
+
+        void enableState(FrozenNet::Index a);
+        // Enables a state which has already been counted in _liveStates. It is added to the thread
+        // pool as a fork, so that an idle worker may run it right away.
+        void startState(FrozenNet::Index a);
+        void disableState(ActiveState &state);
+        // Returns true if the next state is chained, i.e. to be executed by the caller, which is
+        // never the case when several states have been enabled at once, nor when another task has
+        // been handed over to the current worker
+        bool swapStates(ActiveState &state, FrozenNet::Index newAction, bool forked);
+
+        // Evaluates the transitions of a state which has already been executed, until one of them
+        // is fulfilled or until it has to wait. Executed concurrently on the thread pool. Returns
+        // whether the next state is chained, as swapStates().
+        bool evaluateTransitions(ActiveState &state);
+
+        void observeTransitions(ActiveState &state);
+        void stopWaiting(ActiveState &state);
+        void wakeActiveStates();
+        // Waits until all of the states are over, which they are soon once the net is stopped
+        void drain();
+
+        // Ends the execution once the last live state is over
+        void liveStateEnded();
+
+        // Pops a free record, or creates some more if none is left
+        ActiveState &acquireRecord();
+        // Creates records until there are count of them, and makes room for as many observers in
+        // the observed variables, as a state observes each of them at most once. Called under
+        // _activationMutex, or before the net runs.
+        void createRecords(std::uint32_t count);
+        // Pushes a record which is not used anymore on the free records stack
+        void releaseRecord(ActiveState &record);
+        ActiveState &record(std::uint32_t index);
+
+        // Signalled when the execution is over, and when the last state is over. The count of the
+        // live states only drops to 0 under the mutex, so that the net can be destroyed once
+        // drain() returns although the worker threads may be shared with other nets.
         std::condition_variable _activationCondition;
-        std::multiset<Action *> _activeStates;
         std::mutex _activationMutex;
 
+        // All of the records ever created, which are reused so that an execution cycle does not
+        // allocate any memory. As many records as the estimated parallelism of the net are created
+        // when it is frozen, and more of them, under _activationMutex, only when more states than
+        // that are active at once. They are numbered in creation order, and indexed by blocks of
+        // 64 << k records.
+        std::list<ActiveState> _records;
+        std::array<std::unique_ptr<ActiveState *[]>, 26> _recordsIndex;
+        std::uint32_t _recordsCount = 0;
+
+        // The lock-free stack of the free records: the index of the top one in the low 32 bits, and
+        // a counter incremented at each update in the high ones against the ABA problem.
+        enum : std::uint32_t { NoRecord = 0xFFFFFFFF };
+        std::atomic<std::uint64_t> _freeRecords = {NoRecord};
+
+        // The number of active states, the execution ending when it drops to 0
+        std::atomic_size_t _liveStates = {0};
+
         std::atomic_bool _running = {false};
-        ThreadPool<void> _actionsPool;
+        // The worker threads may be shared with other instances, see _executingNet
+        std::shared_ptr<WorkStealingThreadPool<void>> _actionsPool;
+        // The net whose state is being executed by the calling worker thread, if any
+        static thread_local Internals const *_executingNet;
+        std::atomic_size_t _chainDepth = {16};
 
         std::string const _name;
-        std::list<std::pair<Action, bool>> _states;
-        std::list<Transition> _transitions;
+        // The memory of the actions and transitions of the net, released when it is destroyed after
+        // all of them
+        Arena _arena;
+        std::list<std::pair<Action, bool>, ArenaAllocator<std::pair<Action, bool>>> _states{&_arena};
+
+        std::shared_ptr<FrozenNet const> _frozen;
+        bool _isFrozen = false;
+        // The net whose frozen form is shared by this instance, and which owns its actions
+        std::shared_ptr<PetriNet> _prototype;
+
+        // The marking of the net, indexed by action: the tokens of each action, and the number of
+        // its active states. They are the counters of the actions themselves, except in the
+        // instances of a prototype, which own theirs in _counters.
+        std::vector<std::atomic_size_t *> _tokens;
+        std::vector<std::atomic_size_t *> _activations;
+        std::unique_ptr<std::atomic_size_t[]> _counters;
 
-        std::map<std::uint_fast32_t, std::unique_ptr<Atomic>> _variables;
+        VariableTable _variables;
+        // The variables of the net, indexed as FrozenNet::variableIds
+        std::vector<Atomic *> _frozenVariables;
 
         PetriNet &_this;
     };
+
+    /**
+     * An activation of a state, from the execution of its action to the crossing of one of its
+     * transitions, after which it is reused for the next state. It is the task executed on the
+     * thread pool, and never blocks its worker thread: when none of its transitions is fulfilled, it
+     * is parked until one of the variables its pure transitions depend on changes, or until its next
+     * polled transition is due in the TimerWheel, and is then evaluated again on the thread pool.
+     */
+    struct PetriNet::Internals::ActiveState : public AtomicObserver, public Timer, public PoolTask {
+        enum Status {
+            // Parked, nothing to do until woken up
+            Waiting,
+            // Added to the thread pool
+            Scheduled,
+            // Being executed or evaluated by a worker thread
+            Evaluating,
+            // Being evaluated, and woken up in the meantime: it will be evaluated again
+            EvaluatingWoken,
+        };
+
+        ActiveState(Internals &internals)
+                : _internals(internals) {}
+
+        /**
+         * Prepares the record for the activation of a state, before it is added to the thread pool.
+         * @param state The index of the state to be executed
+         */
+        void activate(FrozenNet::Index state);
+
+        void runTask() override;
+        void atomicChanged() override;
+        void timerExpired() override;
+
+        /**
+         * Makes sure the state will be evaluated again, either by adding it to the thread pool if
+         * it is parked, or by notifying the worker which is currently evaluating it.
+         */
+        void wake();
+
+        Internals &_internals;
+        FrozenNet::Index _state = 0;
+        actionResult_t _result = {};
+        bool _executed = false;
+
+        // Their capacity is kept when the record is reused
+        std::vector<FrozenNet::Index> _transitionsToTest;
+        std::vector<Atomic *> _observed;
+        // The sum of the versions of the variables of each transition of the state when it was last
+        // evaluated, indexed from the first transition of the state
+        std::vector<std::uint64_t> _versions;
+
+        ClockType::time_point _lastTest = ClockType::time_point();
+        bool _firstTest = true;
+        // The number of states executed in a row by the current worker
+        std::size_t _chained = 0;
+
+        // The position of the record in Internals::_recordsIndex, and the index of the next record
+        // in the free records stack
+        std::uint32_t _index = 0;
+        std::atomic<std::uint32_t> _nextFree = {NoRecord};
+
+        std::atomic_int _status = {Scheduled};
+    };
 }
 
 
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+//
+//  PetriNetPrototype.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#include "../PetriNetPrototype.h"
+#include "PetriNetImpl.h"
+#include <algorithm>
+
+namespace Petri {
+
+    PetriNetPrototype::PetriNetPrototype(std::unique_ptr<PetriNet> net)
+            : _net(std::move(net)) {
+        if(_net->running()) {
+            throw std::runtime_error("Cannot create the prototype of a running petri net!");
+        }
+
+        _net->freeze();
+
+        // The instances run on the worker threads of the prototype, which are as many as the cores
+        // as any number of instances may be running at the same time.
+        _net->_internals->_actionsPool->start(std::max(2u, std::thread::hardware_concurrency()));
+    }
+
+    PetriNetPrototype::~PetriNetPrototype() = default;
+
+    std::unique_ptr<PetriNet> PetriNetPrototype::createInstance() const {
+        return std::unique_ptr<PetriNet>(new PetriNet(_net));
+    }
+
+    std::string const &PetriNetPrototype::name() const {
+        return _net->name();
+    }
+}
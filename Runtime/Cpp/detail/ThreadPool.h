@@ -44,114 +44,168 @@ namespace Petri {
 
     template <typename CallableType>
     auto make_callable(CallableType &&c) {
-        return Callable<CallableType, std::result_of_t<CallableType()>>(c);
+        return InlineCallable<std::result_of_t<std::decay_t<CallableType>()>()>(std::forward<CallableType>(c));
     }
 
     template <typename _ReturnType>
-    class ThreadPool {
-        using ReturnType = _ReturnType;
+    class ThreadPool;
+    template <typename _ReturnType>
+    class WorkStealingThreadPool;
 
-        struct TaskManager {
-            // We want a steady clock (no adjustments, only ticking forward in time), but it would
-            // be better if we got an high resolution clock.
-            using ClockType =
-            std::conditional<std::chrono::high_resolution_clock::is_steady, std::chrono::high_resolution_clock, std::chrono::steady_clock>::type;
+    /**
+     * A task which can be added to a WorkStealingThreadPool without allocating any memory, as the
+     * pool only links it in its queues. It is not owned by the pool: it must stay alive until it is
+     * executed or dropped, and must not be added again before its execution has started.
+     */
+    class PoolTask {
+        template <typename>
+        friend class WorkStealingThreadPool;
 
-            // Defined to char if ReturnType is void, so that we can nevertheless create a member
-            // variable of this type
-            using VoidProofReturnType =
-            typename std::conditional<std::is_same<ReturnType, void>::value, char, ReturnType>::type;
+    public:
+        /**
+         * Executes the task on a worker thread. The pool does not access the task anymore once it
+         * has been called, so the task may be added again or destroyed from there.
+         */
+        virtual void runTask() = 0;
 
-            TaskManager(std::unique_ptr<CallableBase<ReturnType>> task)
-                    : _task(std::move(task)) {
-            } //, std::chrono::nanoseconds timeout, VoidProofReturnType returnWhenTimeout =
-            // VoidProofReturnType()) : _task(std::move(task)), _timeout(timeout),
-            //_res(returnWhenTimeout) {}
+        /**
+         * Called instead of runTask() when the pool is stopped while the task is still pending.
+         */
+        virtual void dropTask() {}
 
-            ReturnType returnValue() {
-                this->waitForCompletion();
+    protected:
+        ~PoolTask() = default;
 
-                // No value if void
-                return ReturnType(_res);
-            }
+    private:
+        PoolTask *_nextTask = nullptr;
+    };
 
-            void waitForCompletion() {
-                std::unique_lock<std::mutex> lk(_mut);
-                _cv.wait(lk, [this]() { return _valOK == true; });
-            }
+    // The shared state of a task and of the TaskResult objects associated to it.
+    template <typename ReturnType>
+    struct TaskManager : public PoolTask {
+        // We want a steady clock (no adjustments, only ticking forward in time), but it would
+        // be better if we got an high resolution clock.
+        using ClockType =
+        std::conditional<std::chrono::high_resolution_clock::is_steady, std::chrono::high_resolution_clock, std::chrono::steady_clock>::type;
+
+        // Defined to char if ReturnType is void, so that we can nevertheless create a member
+        // variable of this type
+        using VoidProofReturnType =
+        typename std::conditional<std::is_same<ReturnType, void>::value, char, ReturnType>::type;
+
+        TaskManager(InlineCallable<ReturnType()> task)
+                : _task(std::move(task)) {
+        } //, std::chrono::nanoseconds timeout, VoidProofReturnType returnWhenTimeout =
+        // VoidProofReturnType()) : _task(std::move(task)), _timeout(timeout),
+        //_res(returnWhenTimeout) {}
+
+        ReturnType returnValue() {
+            this->waitForCompletion();
+
+            // No value if void
+            return ReturnType(_res);
+        }
 
-            // Void version, simply exectutes the task
-            template <typename _Helper = void>
-            std::enable_if_t<(std::is_void<_Helper>::value, std::is_void<ReturnType>::value), void> execute() {
-                _task->operator()();
-                this->signalCompletion();
-            }
+        void waitForCompletion() {
+            std::unique_lock<std::mutex> lk(_mut);
+            _cv.wait(lk, [this]() { return _valOK == true; });
+        }
 
-            // Non-void version, executes the task and stores it in _res
-            template <typename _Helper = void>
-            std::enable_if_t<(std::is_void<_Helper>::value, !std::is_void<ReturnType>::value), void> execute() {
-                _res = std::move(_task->operator()());
-                this->signalCompletion();
-            }
+        // Void version, simply exectutes the task
+        template <typename _Helper = void>
+        std::enable_if_t<(std::is_void<_Helper>::value, std::is_void<ReturnType>::value), void> execute() {
+            _task();
+            this->signalCompletion();
+        }
 
-            // Signals the completion of the task to _cv, usually to the thread which called
-            // waitForCompletion()
-            void signalCompletion() {
-                _valOK = true;
-                _cv.notify_all();
-            }
+        // Non-void version, executes the task and stores it in _res
+        template <typename _Helper = void>
+        std::enable_if_t<(std::is_void<_Helper>::value, !std::is_void<ReturnType>::value), void> execute() {
+            _res = _task();
+            this->signalCompletion();
+        }
 
-            std::condition_variable _cv;
-            std::mutex _mut;
-            std::atomic_bool _valOK = {false};
+        // Signals the completion of the task to _cv, usually to the thread which called
+        // waitForCompletion()
+        void signalCompletion() {
+            _valOK = true;
+            _cv.notify_all();
+        }
+
+        std::condition_variable _cv;
+        std::mutex _mut;
+        std::atomic_bool _valOK = {false};
 
-            /*std::chrono::nanoseconds _timeout;
-             std::chrono::time_point<ClockType> _timeoutDate;*/
+        /*std::chrono::nanoseconds _timeout;
+         std::chrono::time_point<ClockType> _timeoutDate;*/
 
-            VoidProofReturnType _res;
-            std::unique_ptr<CallableBase<ReturnType>> _task;
-        };
+        VoidProofReturnType _res;
+        InlineCallable<ReturnType()> _task;
+
+        void runTask() override {
+            auto self = std::move(_self);
+            this->execute();
+        }
+
+        void dropTask() override {
+            _self.reset();
+        }
+
+        // Keeps the task alive while it is only referenced by raw pointers in a thread pool's queues
+        std::shared_ptr<TaskManager> _self;
+    };
+
+    template <typename ReturnType>
+    class TaskResult {
+        template <typename>
+        friend class ThreadPool;
+        template <typename>
+        friend class WorkStealingThreadPool;
 
     public:
-        class TaskResult {
-            friend class ThreadPool;
-
-        public:
-            TaskResult() = default;
-
-            /**
-             * Gets the return value of the task, blocks the calling thread until the result is made
-             * available.
-             * Not available for ResultType == void specialization
-             * @return The return value associated to the task and computed by the worker thread
-             */
-            template <typename _Helper = void>
-            std::enable_if_t<(std::is_void<_Helper>::value, !std::is_void<ReturnType>::value), ReturnType>
-            returnValue() {
-                return _proxy ? _proxy->returnValue() :
-                                throw std::runtime_error("Proxy not associated with a task!");
-            }
+        TaskResult() = default;
 
-            /**
-             * Blocks the calling thread until the task is complete and the result is available (no
-             * result for tasks returning void).
-             */
-            void waitForCompletion() {
-                _proxy ? _proxy->waitForCompletion() :
-                         throw std::runtime_error("Proxy not associated with a task!");
-            }
+        /**
+         * Gets the return value of the task, blocks the calling thread until the result is made
+         * available.
+         * Not available for ResultType == void specialization
+         * @return The return value associated to the task and computed by the worker thread
+         */
+        template <typename _Helper = void>
+        std::enable_if_t<(std::is_void<_Helper>::value, !std::is_void<ReturnType>::value), ReturnType>
+        returnValue() {
+            return _proxy ? _proxy->returnValue() :
+                            throw std::runtime_error("Proxy not associated with a task!");
+        }
 
-            /**
-             * Checks whether the task result is available.
-             * @return Availability of the task result
-             */
-            bool available() {
-                return _proxy ? static_cast<bool>(_proxy->_valOK) : false;
-            }
+        /**
+         * Blocks the calling thread until the task is complete and the result is available (no
+         * result for tasks returning void).
+         */
+        void waitForCompletion() {
+            _proxy ? _proxy->waitForCompletion() :
+                     throw std::runtime_error("Proxy not associated with a task!");
+        }
 
-        private:
-            std::shared_ptr<TaskManager> _proxy;
-        };
+        /**
+         * Checks whether the task result is available.
+         * @return Availability of the task result
+         */
+        bool available() {
+            return _proxy ? static_cast<bool>(_proxy->_valOK) : false;
+        }
+
+    private:
+        std::shared_ptr<TaskManager<ReturnType>> _proxy;
+    };
+
+    template <typename _ReturnType>
+    class ThreadPool {
+        using ReturnType = _ReturnType;
+        using TaskManager = Petri::TaskManager<ReturnType>;
+
+    public:
+        using TaskResult = Petri::TaskResult<ReturnType>;
 
     public:
         /**
@@ -203,16 +257,17 @@ namespace Petri {
         }
 
         /**
-         * Pauses the calling thread until there is no more pending tasks.
+         * Pauses the calling thread until there is no more pending tasks, or until the pool is
+         * stopped by another thread, and then shuts down the working threads.
          */
         void join() {
             if(_alive) {
-                // Dirty hack…
-                while(_pendingTasks > 0) {
-                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                {
+                    std::unique_lock<std::mutex> lk(_idleMutex);
+                    _idle.wait(lk, [this]() { return !_alive || _pendingTasks == 0; });
                 }
 
-                this->cancel();
+                this->stop();
             }
         }
 
@@ -223,9 +278,19 @@ namespace Petri {
         void stop() {
             _alive = false;
             _taskAvailable.notify_all();
+            this->notifyIdle();
+
+            // A worker cannot wait for the others, as the owner of the pool may be waiting for it:
+            // the pool is joined when stopped by its owner.
+            for(auto &t : _workerThreads) {
+                if(t.get_id() == std::this_thread::get_id()) {
+                    return;
+                }
+            }
 
+            std::lock_guard<std::mutex> lk(_stopMutex);
             for(auto &t : _workerThreads) {
-                if(t.joinable() && t.get_id() != std::this_thread::get_id())
+                if(t.joinable())
                     t.join();
             }
 
@@ -265,10 +330,10 @@ namespace Petri {
          * completion status and get the task return value
          */
         TaskResult
-        addTask(CallableBase<ReturnType> const &task) { //, std::chrono::nanoseconds timeout) {
+        addTask(InlineCallable<ReturnType()> task) { //, std::chrono::nanoseconds timeout) {
             TaskResult result;
-            // task must be kept alive until execution finishes
-            result._proxy = std::make_shared<TaskManager>(task.copy_ptr());
+            // The task is stored in its manager, which is kept alive until the execution finishes
+            result._proxy = std::make_shared<TaskManager>(std::move(task));
 
             std::lock_guard<std::mutex> lk(_availabilityMutex);
             ++_pendingTasks;
@@ -297,14 +362,28 @@ namespace Petri {
 
                 taskManager->execute();
 
-                --_pendingTasks;
+                if(--_pendingTasks == 0) {
+                    this->notifyIdle();
+                }
             }
         }
 
+        void notifyIdle() {
+            // Locked so that a thread about to wait in join() can not miss it
+            { std::lock_guard<std::mutex> idleLock(_idleMutex); }
+            _idle.notify_all();
+        }
+
         std::queue<std::shared_ptr<TaskManager>> _taskQueue;
         std::condition_variable _taskAvailable;
         std::mutex _availabilityMutex;
 
+        std::mutex _stopMutex;
+
+        // Signalled when there is no pending task left, or when the pool is stopped
+        std::condition_variable _idle;
+        std::mutex _idleMutex;
+
         std::atomic_bool _pause = {false};
         std::atomic_bool _alive = {true};
         std::atomic_uint _pendingTasks = {0};
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  TimerWheel.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#include "TimerWheel.h"
+#include "../Common.h"
+#include <algorithm>
+#include <limits>
+
+namespace Petri {
+
+    constexpr std::chrono::nanoseconds TimerWheel::TickDuration;
+
+    TimerWheel &TimerWheel::instance() {
+        static TimerWheel wheel;
+        return wheel;
+    }
+
+    TimerWheel::TimerWheel()
+            : _epoch(ClockType::now()) {
+        _wakeTick = std::numeric_limits<std::uint64_t>::max();
+        _thread = std::thread(&TimerWheel::run, this);
+    }
+
+    TimerWheel::~TimerWheel() {
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            _alive = false;
+        }
+        _wakeUp.notify_all();
+        _thread.join();
+    }
+
+    void TimerWheel::schedule(Timer &timer, ClockType::time_point deadline) {
+        std::uint64_t expiry = this->ceilTick(deadline);
+        bool wakeUp;
+        {
+            std::lock_guard<std::mutex> lk(_mutex);
+            if(timer._scheduled) {
+                this->unlink(timer);
+            }
+            timer._expiry = expiry;
+            this->insert(timer);
+
+            // The timer thread only has to be woken up if it would otherwise sleep past the new
+            // deadline.
+            wakeUp = expiry < _wakeTick;
+            if(wakeUp) {
+                _wakeTick = expiry;
+            }
+        }
+
+        if(wakeUp) {
+            _wakeUp.notify_one();
+        }
+    }
+
+    void TimerWheel::cancel(Timer &timer) {
+        std::lock_guard<std::mutex> lk(_mutex);
+        if(timer._scheduled) {
+            this->unlink(timer);
+        }
+    }
+
+    void TimerWheel::run() {
+        setThreadName("Petri timer wheel");
+
+        std::unique_lock<std::mutex> lk(_mutex);
+        while(_alive) {
+            this->advance(this->floorTick(ClockType::now()));
+
+            std::uint64_t next;
+            if(this->nextEvent(next)) {
+                _wakeTick = next;
+                _wakeUp.wait_until(lk, _epoch + std::chrono::duration_cast<ClockType::duration>(next * TickDuration));
+            } else {
+                _wakeTick = std::numeric_limits<std::uint64_t>::max();
+                _wakeUp.wait(lk);
+            }
+        }
+    }
+
+    std::uint64_t TimerWheel::floorTick(ClockType::time_point date) const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(date - _epoch).count();
+        return elapsed <= 0 ? 0 : std::uint64_t(elapsed) / TickDuration.count();
+    }
+
+    std::uint64_t TimerWheel::ceilTick(ClockType::time_point date) const {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(date - _epoch).count();
+        return elapsed <= 0 ? 0 : (std::uint64_t(elapsed) + TickDuration.count() - 1) / TickDuration.count();
+    }
+
+    // The timers of level L are stored in the slot of their period, i.e. of their expiry tick
+    // divided by SlotCount^L. A slot of level L > 0 is cascaded into the lower levels when the
+    // current tick reaches the beginning of its period, and a slot of level 0 is fired when the
+    // current tick reaches it.
+    void TimerWheel::insert(Timer &timer) {
+        std::uint64_t expiry = std::max(timer._expiry, _currentTick);
+        std::uint64_t delta = expiry - _currentTick;
+
+        unsigned level = 0;
+        while(level < Levels - 1 && delta >= (std::uint64_t(1) << ((level + 1) * LevelBits))) {
+            ++level;
+        }
+
+        unsigned shift = level * LevelBits;
+        std::uint64_t period = expiry >> shift;
+        if(delta >= (std::uint64_t(1) << (Levels * LevelBits))) {
+            // Too far in the future: parked in the farthest slot, and inserted again when cascaded.
+            period = (_currentTick >> shift) + SlotCount - 1;
+        }
+
+        timer._level = level;
+        timer._slot = unsigned(period & SlotMask);
+        timer._previous = nullptr;
+        timer._next = _slots[level][timer._slot];
+        if(timer._next) {
+            timer._next->_previous = &timer;
+        }
+        _slots[level][timer._slot] = &timer;
+        _occupied[level] |= std::uint64_t(1) << timer._slot;
+        timer._scheduled = true;
+    }
+
+    void TimerWheel::unlink(Timer &timer) {
+        if(timer._previous) {
+            timer._previous->_next = timer._next;
+        } else {
+            _slots[timer._level][timer._slot] = timer._next;
+            if(!timer._next) {
+                _occupied[timer._level] &= ~(std::uint64_t(1) << timer._slot);
+            }
+        }
+        if(timer._next) {
+            timer._next->_previous = timer._previous;
+        }
+
+        timer._previous = timer._next = nullptr;
+        timer._scheduled = false;
+    }
+
+    Timer *TimerWheel::detachSlot(unsigned level, unsigned slot) {
+        Timer *head = _slots[level][slot];
+        _slots[level][slot] = nullptr;
+        _occupied[level] &= ~(std::uint64_t(1) << slot);
+
+        return head;
+    }
+
+    bool TimerWheel::nextEvent(std::uint64_t &tick) const {
+        bool found = false;
+        for(unsigned level = 0; level < Levels; ++level) {
+            if(_occupied[level] == 0) {
+                continue;
+            }
+
+            // First period of this level not starting before the current tick
+            unsigned shift = level * LevelBits;
+            std::uint64_t first = (_currentTick + (std::uint64_t(1) << shift) - 1) >> shift;
+
+            unsigned rotation = unsigned(first & SlotMask);
+            std::uint64_t occupied = _occupied[level];
+            if(rotation) {
+                occupied = (occupied >> rotation) | (occupied << (SlotCount - rotation));
+            }
+
+            std::uint64_t candidate = (first + __builtin_ctzll(occupied)) << shift;
+            if(!found || candidate < tick) {
+                tick = candidate;
+                found = true;
+            }
+        }
+
+        return found;
+    }
+
+    void TimerWheel::advance(std::uint64_t now) {
+        std::uint64_t tick;
+        while(this->nextEvent(tick) && tick <= now) {
+            _currentTick = tick;
+
+            for(unsigned level = Levels - 1; level > 0; --level) {
+                unsigned shift = level * LevelBits;
+                if((tick & ((std::uint64_t(1) << shift) - 1)) == 0) {
+                    Timer *timer = this->detachSlot(level, unsigned((tick >> shift) & SlotMask));
+                    while(timer) {
+                        Timer *next = timer->_next;
+                        this->insert(*timer);
+                        timer = next;
+                    }
+                }
+            }
+
+            Timer *timer = this->detachSlot(0, unsigned(tick & SlotMask));
+            while(timer) {
+                Timer *next = timer->_next;
+                timer->_previous = timer->_next = nullptr;
+                timer->_scheduled = false;
+                timer->timerExpired();
+                timer = next;
+            }
+
+            _currentTick = tick + 1;
+        }
+
+        _currentTick = std::max(_currentTick, now + 1);
+    }
+}
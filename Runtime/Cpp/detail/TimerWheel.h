@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  TimerWheel.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#ifndef Petri_TimerWheel_h
+#define Petri_TimerWheel_h
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace Petri {
+
+    class TimerWheel;
+
+    /**
+     * A timer to be scheduled in the TimerWheel. It is meant to be inherited by the object which is
+     * to be woken up, so that scheduling a timer never allocates memory.
+     */
+    class Timer {
+        friend class TimerWheel;
+
+    public:
+        /**
+         * Called on the timer thread when the timer expires. It must return quickly, and must not
+         * schedule or cancel any timer.
+         */
+        virtual void timerExpired() = 0;
+
+    protected:
+        ~Timer() = default;
+
+    private:
+        Timer *_previous = nullptr;
+        Timer *_next = nullptr;
+        std::uint64_t _expiry = 0;
+        unsigned _level = 0;
+        unsigned _slot = 0;
+        bool _scheduled = false;
+    };
+
+    /**
+     * A runtime-wide hierarchical timing wheel, running on its own thread. Scheduling and cancelling
+     * a timer are O(1), and the thread only wakes up when some timers are to be fired, so that
+     * thousands of pending timers cost nothing more than their memory.
+     */
+    class TimerWheel {
+    public:
+        using ClockType =
+        std::conditional<std::chrono::high_resolution_clock::is_steady, std::chrono::high_resolution_clock, std::chrono::steady_clock>::type;
+
+        /**
+         * The resolution of the wheel. A timer never fires before its deadline, but may fire up to
+         * one tick after it.
+         */
+        static constexpr std::chrono::nanoseconds TickDuration = std::chrono::microseconds(100);
+
+        /**
+         * Returns the timer wheel shared by all of the petri nets of the process, starting its
+         * thread on first use.
+         */
+        static TimerWheel &instance();
+
+        ~TimerWheel();
+
+        TimerWheel(TimerWheel const &) = delete;
+        TimerWheel &operator=(TimerWheel const &) = delete;
+
+        /**
+         * Schedules a timer so that it expires at the given deadline. A timer which is already
+         * scheduled is rescheduled.
+         * @param timer The timer to schedule
+         * @param deadline The date at which the timer will expire
+         */
+        void schedule(Timer &timer, ClockType::time_point deadline);
+
+        /**
+         * Cancels a timer if it is scheduled. When this method returns, the timer is guaranteed not
+         * to be expiring on the timer thread.
+         * @param timer The timer to cancel
+         */
+        void cancel(Timer &timer);
+
+    private:
+        enum { LevelBits = 6, SlotCount = 1 << LevelBits, SlotMask = SlotCount - 1, Levels = 4 };
+
+        TimerWheel();
+
+        void run();
+
+        std::uint64_t floorTick(ClockType::time_point date) const;
+        std::uint64_t ceilTick(ClockType::time_point date) const;
+
+        void insert(Timer &timer);
+        void unlink(Timer &timer);
+        Timer *detachSlot(unsigned level, unsigned slot);
+        bool nextEvent(std::uint64_t &tick) const;
+        void advance(std::uint64_t now);
+
+        std::array<std::array<Timer *, SlotCount>, Levels> _slots = {};
+        std::array<std::uint64_t, Levels> _occupied = {};
+        std::uint64_t _currentTick = 0;
+        std::uint64_t _wakeTick = 0;
+
+        ClockType::time_point const _epoch;
+        bool _alive = true;
+        std::mutex _mutex;
+        std::condition_variable _wakeUp;
+        std::thread _thread;
+    };
+}
+
+#endif
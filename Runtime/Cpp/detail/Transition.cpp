@@ -29,40 +29,68 @@
 
 #include "../Action.h"
 #include "../Transition.h"
+#include "NameTable.h"
 
 namespace Petri {
 
     struct Transition::Internals {
-        Internals(Action &previous, Action &next)
-                : _previous(&previous)
+        Internals(Arena *arena, Action &previous, Action &next)
+                : _arena(arena)
+                , _previous(&previous)
                 , _next(&next) {}
 
-        Internals(std::string const &name, Action &previous, Action &next, ParametrizedTransitionCallableBase const &cond)
-                : _name(name)
+        Internals(Arena *arena, InternedName &&name, Action &previous, Action &next, ParametrizedTransitionCallable const &cond)
+                : _arena(arena)
+                , _name(std::move(name))
                 , _previous(&previous)
                 , _next(&next)
-                , _test(cond.copy_ptr()) {}
+                , _test(cond) {}
 
-        std::string _name;
+        // The arena the internals are allocated from, if any
+        Arena *_arena;
+        InternedName _name;
         Action *_previous;
         Action *_next;
-        std::unique_ptr<ParametrizedTransitionCallableBase> _test;
+        ParametrizedTransitionCallable _test;
 
         // Default delay between evaluation
         std::chrono::nanoseconds _delayBetweenEvaluation = 10ms;
+
+        bool _pure = false;
+        bool _hasExpectedResult = false;
+        actionResult_t _expectedResult = {};
     };
 
-    Transition::Transition(Action &previous, Action &next)
-            : Entity(0)
-            , _internals(std::make_unique<Internals>(previous, next)) {}
+    namespace {
+        template <typename Internals, typename... Args>
+        Internals *makeInternals(Arena *arena, Args &&... args) {
+            if(arena) {
+                return arena->create<Internals>(arena, std::forward<Args>(args)...);
+            }
+            return new Internals(nullptr, std::forward<Args>(args)...);
+        }
+    }
+
+    Transition::Transition(Action &previous, Action &next, Arena *arena)
+            : Entity(0, arena)
+            , _internals(makeInternals<Internals>(arena, previous, next)) {}
 
     Transition::Transition(uint64_t id,
-                           std::string const &name,
+                           InternedName &&name,
                            Action &previous,
                            Action &next,
-                           ParametrizedTransitionCallableBase const &cond)
-            : Entity(id)
-            , _internals(std::make_unique<Internals>(name, previous, next, cond)) {}
+                           ParametrizedTransitionCallable const &cond,
+                           Arena *arena)
+            : Entity(id, arena)
+            , _internals(makeInternals<Internals>(arena, std::move(name), previous, next, cond)) {}
+
+    void Transition::InternalsDeleter::operator()(Internals *internals) const noexcept {
+        if(internals->_arena) {
+            internals->~Internals();
+        } else {
+            delete internals;
+        }
+    }
 
     Transition::~Transition() = default;
     Transition::Transition(Transition &&) noexcept = default;
@@ -75,22 +103,24 @@ namespace Petri {
     }
 
     bool Transition::isFulfilled(PetriNet &pn, actionResult_t actionResult) const {
-        return (*_internals->_test)(pn, actionResult);
+        return _internals->_test(pn, actionResult);
     }
 
-    ParametrizedTransitionCallableBase const &Transition::condition() const noexcept {
-        return *_internals->_test;
+    ParametrizedTransitionCallable const &Transition::condition() const noexcept {
+        return _internals->_test;
     }
 
-    void Transition::setCondition(TransitionCallableBase const &test) {
-        auto copy = test.copy_ptr();
-        auto shared_copy = std::shared_ptr<TransitionCallableBase>(copy.release());
-        this->setCondition(make_param_transition_callable(
-        std::move([shared_copy](PetriNet &, actionResult_t a) { return shared_copy->operator()(a); })));
+    void Transition::setCondition(TransitionCallable const &test) {
+        // A plain function is captured on its own, so that the wrapper is stored inline
+        if(auto function = test.function()) {
+            this->setCondition(make_param_transition_callable([function](PetriNet &, actionResult_t a) { return function(a); }));
+        } else {
+            this->setCondition(make_param_transition_callable([test](PetriNet &, actionResult_t a) { return test(a); }));
+        }
     }
 
-    void Transition::setCondition(ParametrizedTransitionCallableBase const &test) {
-        _internals->_test = test.copy_ptr();
+    void Transition::setCondition(ParametrizedTransitionCallable const &test) {
+        _internals->_test = test;
     }
 
     Action &Transition::previous() noexcept {
@@ -102,11 +132,11 @@ namespace Petri {
     }
 
     std::string const &Transition::name() const noexcept {
-        return _internals->_name;
+        return *_internals->_name;
     }
 
     void Transition::setName(std::string const &name) {
-        _internals->_name = name;
+        _internals->_name = InternedName(name);
     }
 
     std::chrono::nanoseconds Transition::delayBetweenEvaluation() const {
@@ -116,4 +146,25 @@ namespace Petri {
     void Transition::setDelayBetweenEvaluation(std::chrono::nanoseconds delay) {
         _internals->_delayBetweenEvaluation = delay;
     }
+
+    bool Transition::isPure() const noexcept {
+        return _internals->_pure;
+    }
+
+    void Transition::setPure(bool pure) noexcept {
+        _internals->_pure = pure;
+    }
+
+    bool Transition::hasExpectedResult() const noexcept {
+        return _internals->_hasExpectedResult;
+    }
+
+    actionResult_t Transition::expectedResult() const noexcept {
+        return _internals->_expectedResult;
+    }
+
+    void Transition::setExpectedResult(actionResult_t result) noexcept {
+        _internals->_hasExpectedResult = true;
+        _internals->_expectedResult = result;
+    }
 }
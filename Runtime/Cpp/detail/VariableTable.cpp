@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  VariableTable.cpp
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+
+#include "VariableTable.h"
+#include <new>
+
+namespace Petri {
+
+    constexpr std::size_t VariableTable::CacheLineSize;
+    constexpr std::uint_fast32_t VariableTable::DenseIds;
+    constexpr std::size_t VariableTable::SlotSize;
+
+    void VariableTable::Block::allocate(std::size_t slot) {
+        auto const chunk = slot >> ChunkBits;
+        if(chunks[chunk] == nullptr) {
+            storage[chunk].reset(new unsigned char[ChunkSize * SlotSize + CacheLineSize]);
+            auto address = reinterpret_cast<std::uintptr_t>(storage[chunk].get());
+            address = (address + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+            chunks[chunk] = reinterpret_cast<unsigned char *>(address);
+        }
+    }
+
+    VariableTable::~VariableTable() {
+        this->forEach([](std::uint_fast32_t, Atomic &atomic) { atomic.~Atomic(); });
+    }
+
+    Atomic &VariableTable::add(std::uint_fast32_t id) {
+        if(auto atomic = this->find(id)) {
+            return *atomic;
+        }
+
+        auto const index = id >> BlockBits;
+        std::unique_ptr<Block> *block;
+        if(id < DenseIds) {
+            if(index >= _blocks.size()) {
+                _blocks.resize(index + 1);
+            }
+            block = &_blocks[index];
+        } else {
+            block = &_sparseBlocks[index];
+        }
+        if(!*block) {
+            *block = std::make_unique<Block>();
+        }
+
+        auto const slot = id & SlotMask;
+        (*block)->allocate(slot);
+        auto atomic = new((*block)->at(slot)) Atomic();
+        (*block)->present |= std::uint64_t(1) << slot;
+
+        return *atomic;
+    }
+}
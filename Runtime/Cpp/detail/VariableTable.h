@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  VariableTable.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+
+#ifndef Petri_VariableTable_h
+#define Petri_VariableTable_h
+
+#include "../Atomic.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace Petri {
+
+    /**
+     * The Atomic variables of a petri net, stored in cache line aligned chunks of contiguous slots
+     * and indexed directly by their id. A chunk is only allocated once one of its slots is used,
+     * so that the instances of a net with a few variables stay small. The ids are expected to be
+     * dense, as are the values of the enum generated for the variables of a petri net document:
+     * the blocks of the ids below DenseIds are indexed by a directory, and those of the greater
+     * ids are looked up in a sparse map, so that an arbitrary id does not allocate a directory
+     * covering all the ids below it. A variable never moves once added, so that references to it
+     * stay valid until the table is destroyed.
+     * When the PETRI_PAD_VARIABLES macro is defined, each variable occupies its own cache lines, so
+     * that the variables modified concurrently by different threads do not suffer from false
+     * sharing.
+     */
+    class VariableTable {
+    public:
+        static constexpr std::size_t CacheLineSize = 64;
+        // The ids below this bound are indexed directly, the others through a sparse map
+        static constexpr std::uint_fast32_t DenseIds = 1 << 16;
+
+        VariableTable() = default;
+        ~VariableTable();
+
+        VariableTable(VariableTable const &) = delete;
+        VariableTable &operator=(VariableTable const &) = delete;
+
+        /**
+         * Adds the variable designated by the specified id, if it does not exist yet.
+         * @param id The id of the variable
+         * @return The variable designated by the id
+         */
+        Atomic &add(std::uint_fast32_t id);
+
+        /**
+         * Finds the variable designated by the specified id.
+         * @param id The id of the variable
+         * @return The variable, or nullptr if it has not been added
+         */
+        Atomic *find(std::uint_fast32_t id) const noexcept {
+            auto const block = this->block(id >> BlockBits);
+            if(!block) {
+                return nullptr;
+            }
+
+            auto const slot = id & SlotMask;
+            if((block->present & (std::uint64_t(1) << slot)) == 0) {
+                return nullptr;
+            }
+
+            return block->at(slot);
+        }
+
+        /**
+         * Calls a function on each of the variables, in the order of their ids.
+         * @param function The function, taking the id of the variable and an Atomic & argument
+         */
+        template <typename Function>
+        void forEach(Function &&function) const {
+            this->forEachBlock([&function](std::size_t index, Block const &block) {
+                for(std::size_t slot = 0; slot < BlockSize; ++slot) {
+                    if(block.present & (std::uint64_t(1) << slot)) {
+                        function(static_cast<std::uint_fast32_t>((index << BlockBits) | slot), *block.at(slot));
+                    }
+                }
+            });
+        }
+
+    private:
+        enum : std::size_t {
+            BlockBits = 6,
+            BlockSize = std::size_t(1) << BlockBits,
+            SlotMask = BlockSize - 1,
+            ChunkBits = 3,
+            ChunkSize = std::size_t(1) << ChunkBits,
+            ChunkMask = ChunkSize - 1,
+        };
+
+#ifdef PETRI_PAD_VARIABLES
+        static constexpr std::size_t SlotSize = (sizeof(Atomic) + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+#else
+        static constexpr std::size_t SlotSize = sizeof(Atomic);
+#endif
+
+        struct Block {
+            Atomic *at(std::size_t slot) const noexcept {
+                return reinterpret_cast<Atomic *>(chunks[slot >> ChunkBits] + (slot & ChunkMask) * SlotSize);
+            }
+
+            // Allocates the chunk of a slot if it is not allocated yet
+            void allocate(std::size_t slot);
+
+            std::unique_ptr<unsigned char[]> storage[BlockSize / ChunkSize];
+            unsigned char *chunks[BlockSize / ChunkSize] = {};
+            std::uint64_t present = 0;
+        };
+
+        // The block of the specified index, or nullptr if none of its slots has been used
+        Block *block(std::size_t index) const noexcept {
+            if(index < _blocks.size()) {
+                return _blocks[index].get();
+            }
+            if(_sparseBlocks.empty()) {
+                return nullptr;
+            }
+
+            auto it = _sparseBlocks.find(index);
+            return it == _sparseBlocks.end() ? nullptr : it->second.get();
+        }
+
+        // Calls a function on each allocated block and its index, in the order of the indexes
+        template <typename Function>
+        void forEachBlock(Function &&function) const {
+            for(std::size_t index = 0; index < _blocks.size(); ++index) {
+                if(_blocks[index]) {
+                    function(index, *_blocks[index]);
+                }
+            }
+            for(auto &block : _sparseBlocks) {
+                function(block.first, *block.second);
+            }
+        }
+
+        std::vector<std::unique_ptr<Block>> _blocks;
+        std::map<std::size_t, std::unique_ptr<Block>> _sparseBlocks;
+    };
+}
+
+#endif
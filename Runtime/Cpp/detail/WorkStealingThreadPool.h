@@ -0,0 +1,568 @@
+/*
+ * Copyright (c) 2015 Rémi Saurel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+//
+//  WorkStealingThreadPool.h
+//  Pétri
+//
+//  Created by Rémi on 17/10/2016.
+//
+
+#ifndef Petri_WorkStealingThreadPool_h
+#define Petri_WorkStealingThreadPool_h
+
+#include "ThreadPool.h"
+#include <array>
+#include <cstdint>
+
+namespace Petri {
+
+    /**
+     * A bounded deque of pointers, after Chase and Lev (in the C11 formulation of Lê et al.). Its
+     * owner pushes and pops items at its bottom, while any other thread may steal them from its top.
+     */
+    template <typename T, std::size_t Capacity>
+    class WorkStealingDeque {
+        static_assert((Capacity & (Capacity - 1)) == 0, "The capacity must be a power of 2!");
+
+    public:
+        WorkStealingDeque() {
+            for(auto &item : _buffer) {
+                item.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * Pushes an item at the bottom of the deque. Must only be called by the owner of the deque.
+         * @param item The item to push
+         * @return false if the deque is full
+         */
+        bool push(T *item) {
+            std::int64_t bottom = _bottom.load(std::memory_order_relaxed);
+            std::int64_t top = _top.load(std::memory_order_acquire);
+            if(bottom - top >= std::int64_t(Capacity)) {
+                return false;
+            }
+
+            _buffer[bottom & (Capacity - 1)].store(item, std::memory_order_relaxed);
+            _bottom.store(bottom + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * Pops the item at the bottom of the deque, i.e. the last pushed one. Must only be called by
+         * the owner of the deque.
+         * @return The popped item, or nullptr if the deque is empty
+         */
+        T *pop() {
+            std::int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+            _bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t top = _top.load(std::memory_order_relaxed);
+
+            T *item = nullptr;
+            if(top <= bottom) {
+                item = _buffer[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+                if(top == bottom) {
+                    // Last item, which may be concurrently stolen
+                    if(!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                        item = nullptr;
+                    }
+                    _bottom.store(bottom + 1, std::memory_order_relaxed);
+                }
+            } else {
+                _bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return item;
+        }
+
+        /**
+         * Steals the item at the top of the deque, i.e. the first pushed one. May be called by any
+         * thread.
+         * @return The stolen item, or nullptr if the deque is empty or if another thread won the race
+         * for the item
+         */
+        T *steal() {
+            std::int64_t top = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+            if(top < bottom) {
+                T *item = _buffer[top & (Capacity - 1)].load(std::memory_order_relaxed);
+                if(_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    return item;
+                }
+            }
+
+            return nullptr;
+        }
+
+        /**
+         * Checks whether the deque is empty. The result may be outdated as soon as it is returned.
+         * @return true if the deque is empty
+         */
+        bool empty() const {
+            return _bottom.load(std::memory_order_seq_cst) <= _top.load(std::memory_order_seq_cst);
+        }
+
+    private:
+        // The indices are modified by different threads, and are kept on their own cache lines.
+        std::atomic<std::int64_t> _top = {0};
+        char _topPadding[64 - sizeof(std::atomic<std::int64_t>)];
+        std::atomic<std::int64_t> _bottom = {0};
+        char _bottomPadding[64 - sizeof(std::atomic<std::int64_t>)];
+        std::array<std::atomic<T *>, Capacity> _buffer;
+    };
+
+    /**
+     * A thread pool with the same interface as ThreadPool, where each worker has its own deque of
+     * tasks instead of sharing a single queue behind a mutex.
+     * A task added by a worker goes to the worker's LIFO slot, so that the successor of a task is
+     * run next on the same thread while its data are still in cache. The task it replaces in the
+     * slot is pushed to the worker's deque, where idle workers can steal it. The tasks added from
+     * outside of the pool go through a shared injection queue.
+     */
+    template <typename _ReturnType>
+    class WorkStealingThreadPool {
+        using ReturnType = _ReturnType;
+        using TaskManager = Petri::TaskManager<ReturnType>;
+
+        enum { DequeCapacity = 1024 };
+
+        struct Worker {
+            Worker(WorkStealingThreadPool &pool)
+                    : _pool(pool) {}
+
+            WorkStealingThreadPool &_pool;
+            WorkStealingDeque<PoolTask, DequeCapacity> _deque;
+            std::atomic<PoolTask *> _lifoSlot = {nullptr};
+            std::thread _thread;
+        };
+
+    public:
+        using TaskResult = Petri::TaskResult<ReturnType>;
+
+        /**
+         * Creates the thread pool.
+         * @param capacity Number of worker threads, i.e. max number of concurrent task at a given
+         * time
+         * @param name     This string is used for debug purposes: it gives a name to each worker
+         * threads, allowing for fast thread discimination when run through a debugger
+         */
+        WorkStealingThreadPool(std::size_t capacity, std::string const &name = "")
+                : _name(name) {
+            this->start(capacity);
+        }
+
+        /**
+         * Creates the thread pool without any worker thread, so that its size can be chosen later
+         * with start(). The tasks added in the meantime wait for the workers.
+         * @param name This string is used for debug purposes, see the other constructor
+         */
+        explicit WorkStealingThreadPool(std::string const &name)
+                : _name(name) {}
+
+        /**
+         * Spawns the worker threads of a pool created without any, or of a stopped pool, whose
+         * former workers are joined and replaced. This is a no-op if the pool is alive and already
+         * has some workers. It must not be called concurrently with any other method, nor from one
+         * of the workers.
+         * @param capacity Number of worker threads, i.e. max number of concurrent task at a given
+         * time
+         */
+        void start(std::size_t capacity) {
+            if(!_alive) {
+                // The workers are not joined by stop() when it is called from one of them
+                for(auto &worker : _workers) {
+                    if(worker->_thread.joinable()) {
+                        worker->_thread.join();
+                    }
+                }
+                this->clear();
+                _workers.clear();
+                _pendingTasks = 0;
+                _pause = false;
+                _alive = true;
+            }
+            if(!_workers.empty()) {
+                return;
+            }
+
+            capacity = std::max(capacity, std::size_t(1));
+            _workers.reserve(capacity);
+            for(std::size_t i = 0; i < capacity; ++i) {
+                _workers.emplace_back(std::make_unique<Worker>(*this));
+            }
+            for(std::size_t i = 0; i < capacity; ++i) {
+                _workers[i]->_thread =
+                std::thread(&WorkStealingThreadPool::work, this, i, _name + "_worker " + std::to_string(i));
+            }
+        }
+
+        ~WorkStealingThreadPool() {
+            if(_pendingTasks > 0) {
+                std::cerr << "Some tasks are still running!" << std::endl;
+                throw std::runtime_error(
+                "The thread pool is being destroyed while some of its tasks are still pending!");
+            }
+            if(_alive) {
+                std::cerr << "Thread pool is still alive!" << std::endl;
+                throw std::runtime_error("The thread pool is strill alive!");
+            }
+
+            this->clear();
+        }
+
+        /**
+         * Returns the worker threads count, i.e. the max number of concurrent tasks at a given
+         * time.
+         * @return The current worker threads count
+         */
+        std::size_t threadCount() const {
+            return _workers.size();
+        }
+
+        /**
+         * Checks whether the calling thread is one of the worker threads of the pool.
+         * @return true if called from a task of the pool
+         */
+        bool isWorkerThread() const {
+            return _currentWorker != nullptr && &_currentWorker->_pool == this;
+        }
+
+        /**
+         * Checks whether a task has been handed over to the calling worker with addTask(), and is
+         * waiting for its current task to be over.
+         * @return true if called from a worker whose LIFO slot is occupied
+         */
+        bool hasLocalTask() const {
+            return this->isWorkerThread() && _currentWorker->_lifoSlot.load() != nullptr;
+        }
+
+        /**
+         * Pauses the calling thread until there is no more pending tasks.
+         */
+        void join() {
+            std::unique_lock<std::mutex> lk(_idleMutex);
+            _idle.wait(lk, [this]() { return !_alive || _pendingTasks == 0; });
+        }
+
+        /**
+         * Clears all of the pending tasks and shuts down all the working threads.
+         * The thread pool will be ineffective after that, until it is started again.
+         */
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lk(_sleepMutex);
+                _alive = false;
+            }
+            _wakeUp.notify_all();
+            this->notifyIdle();
+
+            // A worker cannot wait for the others, as the owner of the pool may be waiting for it:
+            // the pool is joined when stopped by its owner.
+            if(this->isWorkerThread()) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> stopLock(_stopMutex);
+            for(auto &worker : _workers) {
+                if(worker->_thread.joinable()) {
+                    worker->_thread.join();
+                }
+            }
+
+            // The pending tasks can only be cleared once no worker can access the queues anymore
+            this->clear();
+            _pendingTasks = 0;
+        }
+
+        /**
+         * Pauses the execution of the thread pool. The tasks that were already running are still
+         * executed, but the current and future pending tasks will remain pending until the resume()
+         * method is called.
+         * If the thread pool is not alive, this is a no-op.
+         */
+        void pause() {
+            if(_alive) {
+                _pause = true;
+            }
+        }
+
+        /**
+         * Returns whether the thread pool is paused, in which case its workers do not start any
+         * task.
+         */
+        bool paused() const {
+            return _pause;
+        }
+
+        /**
+         * Resumes the execution of the thread pool. If it wasn't alive and paused before, this is a
+         * no-op.
+         */
+        void resume() {
+            if(_alive) {
+                bool d = true;
+                if(_pause.compare_exchange_strong(d, false)) {
+                    std::lock_guard<std::mutex> lk(_sleepMutex);
+                    _wakeUp.notify_all();
+                }
+            }
+        }
+
+        /**
+         * Adds a task to the thread pool.
+         * @param task The task to be added.
+         * @return A proxy object allowing the user to wait for the task completion, query the task
+         * completion status and get the task return value
+         */
+        TaskResult addTask(InlineCallable<ReturnType()> task) {
+            TaskResult result;
+            // The task is stored in its manager, which is kept alive until the execution finishes
+            result._proxy = std::make_shared<TaskManager>(std::move(task));
+            result._proxy->_self = result._proxy;
+            this->addTask(*result._proxy);
+
+            return result;
+        }
+
+        /**
+         * Adds a task to the thread pool without allocating any memory. The task is not owned by the
+         * pool, see PoolTask. When called from a worker, the task is meant to be the successor of
+         * the current one, and runs on the same worker once the current task is over: the tasks which
+         * do not depend on the current one, such as the ones woken up by an event, should be added
+         * with forkTask() instead.
+         * @param task The task to be added.
+         */
+        void addTask(PoolTask &task) {
+            ++_pendingTasks;
+
+            if(this->isWorkerThread()) {
+                // The worker will run this task as soon as its current one is over. Nobody needs to
+                // be woken up, unless this displaces another task.
+                PoolTask *previous = _currentWorker->_lifoSlot.exchange(&task);
+                if(previous != nullptr) {
+                    if(_currentWorker->_deque.push(previous)) {
+                        this->wakeUpWorker();
+                    } else {
+                        this->inject(previous);
+                    }
+                }
+            } else {
+                this->inject(&task);
+            }
+        }
+
+        /**
+         * Adds a task which is to run concurrently with the current one, such as a branch of a
+         * fork or a task woken up by an event. Unlike addTask(), which hands the task over to the calling worker once its current
+         * task is over, the task is pushed where the other workers can steal it, and an idle one is
+         * woken up. The task is not owned by the pool, see PoolTask.
+         * @param task The task to be added.
+         */
+        void forkTask(PoolTask &task) {
+            ++_pendingTasks;
+
+            if(this->isWorkerThread() && _currentWorker->_deque.push(&task)) {
+                this->wakeUpWorker();
+            } else {
+                this->inject(&task);
+            }
+        }
+
+    private:
+        void work(std::size_t index, std::string const &name) {
+            setThreadName(name);
+
+            Worker &worker = *_workers[index];
+            _currentWorker = &worker;
+
+            while(_alive) {
+                PoolTask *task = _pause ? nullptr : this->findTask(index);
+                if(task != nullptr) {
+                    this->execute(task);
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lk(_sleepMutex);
+                ++_sleepingWorkers;
+                _wakeUp.wait(lk, [this]() { return !_alive || (!_pause && this->hasTask()); });
+                --_sleepingWorkers;
+            }
+
+            _currentWorker = nullptr;
+        }
+
+        PoolTask *findTask(std::size_t index) {
+            Worker &worker = *_workers[index];
+
+            if(worker._lifoSlot.load(std::memory_order_relaxed) != nullptr) {
+                if(PoolTask *task = worker._lifoSlot.exchange(nullptr)) {
+                    return task;
+                }
+            }
+            if(PoolTask *task = worker._deque.pop()) {
+                return task;
+            }
+            if(PoolTask *task = this->popInjected()) {
+                return task;
+            }
+
+            // Stealing from the deques first, and then from the LIFO slots of the other workers as
+            // a last resort, as their owners are about to run them.
+            for(std::size_t i = 1; i < _workers.size(); ++i) {
+                if(PoolTask *task = _workers[(index + i) % _workers.size()]->_deque.steal()) {
+                    return task;
+                }
+            }
+            for(std::size_t i = 1; i < _workers.size(); ++i) {
+                auto &slot = _workers[(index + i) % _workers.size()]->_lifoSlot;
+                if(slot.load(std::memory_order_relaxed) != nullptr) {
+                    if(PoolTask *task = slot.exchange(nullptr)) {
+                        return task;
+                    }
+                }
+            }
+
+            return nullptr;
+        }
+
+        // Whether an idle worker should wake up, or stay awake. It is consistent with findTask(), so
+        // that a worker does not go to sleep while a task it could steal is left in a LIFO slot.
+        bool hasTask() const {
+            if(_injectedCount.load() > 0) {
+                return true;
+            }
+            for(auto &worker : _workers) {
+                if(!worker->_deque.empty() || worker->_lifoSlot.load() != nullptr) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void execute(PoolTask *task) {
+            task->runTask();
+            if(--_pendingTasks == 0) {
+                this->notifyIdle();
+            }
+        }
+
+        void notifyIdle() {
+            // Locked so that a thread about to wait in join() can not miss it
+            { std::lock_guard<std::mutex> lk(_idleMutex); }
+            _idle.notify_all();
+        }
+
+        void inject(PoolTask *task) {
+            {
+                std::lock_guard<std::mutex> lk(_injectionMutex);
+                task->_nextTask = nullptr;
+                if(_injectionTail != nullptr) {
+                    _injectionTail->_nextTask = task;
+                } else {
+                    _injectionHead = task;
+                }
+                _injectionTail = task;
+                ++_injectedCount;
+            }
+            this->wakeUpWorker();
+        }
+
+        PoolTask *popInjected() {
+            if(_injectedCount.load() == 0) {
+                return nullptr;
+            }
+
+            std::lock_guard<std::mutex> lk(_injectionMutex);
+            PoolTask *task = _injectionHead;
+            if(task != nullptr) {
+                _injectionHead = task->_nextTask;
+                if(_injectionHead == nullptr) {
+                    _injectionTail = nullptr;
+                }
+                --_injectedCount;
+            }
+
+            return task;
+        }
+
+        void wakeUpWorker() {
+            // Pairs with the increment of _sleepingWorkers followed by the check of the queues by a
+            // worker going to sleep: either the worker sees the new task, or we see the worker.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if(_sleepingWorkers.load() > 0) {
+                std::lock_guard<std::mutex> lk(_sleepMutex);
+                _wakeUp.notify_one();
+            }
+        }
+
+        // Releases the pending tasks. The workers must not be running anymore.
+        void clear() {
+            for(auto &worker : _workers) {
+                if(PoolTask *task = worker->_lifoSlot.exchange(nullptr)) {
+                    task->dropTask();
+                }
+                while(PoolTask *task = worker->_deque.steal()) {
+                    task->dropTask();
+                }
+            }
+            while(PoolTask *task = this->popInjected()) {
+                task->dropTask();
+            }
+        }
+
+        static thread_local Worker *_currentWorker;
+
+        std::vector<std::unique_ptr<Worker>> _workers;
+
+        // Intrusive FIFO of the tasks added from outside of the pool
+        PoolTask *_injectionHead = nullptr;
+        PoolTask *_injectionTail = nullptr;
+        std::atomic_size_t _injectedCount = {0};
+        std::mutex _injectionMutex;
+
+        std::condition_variable _wakeUp;
+        std::mutex _sleepMutex;
+        std::atomic_size_t _sleepingWorkers = {0};
+
+        std::mutex _stopMutex;
+
+        // Signalled when there is no pending task left, or when the pool is stopped
+        std::condition_variable _idle;
+        std::mutex _idleMutex;
+
+        std::atomic_bool _pause = {false};
+        std::atomic_bool _alive = {true};
+        std::atomic_uint _pendingTasks = {0};
+        std::string const _name;
+    };
+
+    template <typename ReturnType>
+    thread_local typename WorkStealingThreadPool<ReturnType>::Worker *WorkStealingThreadPool<ReturnType>::_currentWorker = nullptr;
+}
+
+#endif